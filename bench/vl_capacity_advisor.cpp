@@ -0,0 +1,376 @@
+// replays vl_trace workloads (see vl_trace.h) against vl_vector with other
+// static capacities and growth policies, and recommends a StaticCapacity per
+// site
+//
+//   vl_capacity_advisor <trace> [--tolerance 0.05] [--repeat 5] [--json]
+//
+// every site of the trace is replayed with StaticCapacity 1 to 256 and 1.5x /
+// 2x growth, on elems of its elem size (rounded up to a power of two, 128
+// bytes at most). for each setting it reports the bytes of one vector, the
+// peak footprint (the live vectors plus their heap arrays), the heap
+// allocations and the best replay time of --repeat runs. the recommendation
+// is the setting with the smallest peak footprint among the ones within
+// --tolerance of the fastest, or within 0.1 ms of it - below that the times
+// of a short trace are mostly noise
+
+#include "../vl_trace.h"
+#include "../vl_vector.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/** the heap use of the replay, one thread at a time */
+struct heap_counters {
+  uint64_t allocations = 0;
+  size_t bytes = 0;
+};
+heap_counters counters;
+
+/** std::allocator that counts into counters */
+template<typename T>
+struct counting_allocator {
+  typedef T value_type;
+
+  counting_allocator () = default;
+  template<typename U>
+  counting_allocator (const counting_allocator<U> &)
+  {}
+
+  T *allocate (size_t count)
+  {
+    ++counters.allocations;
+    counters.bytes += count * sizeof (T);
+    return std::allocator<T> ().allocate (count);
+  }
+  void deallocate (T *arr, size_t count)
+  {
+    counters.bytes -= count * sizeof (T);
+    std::allocator<T> ().deallocate (arr, count);
+  }
+
+  template<typename U>
+  bool operator== (const counting_allocator<U> &) const
+  { return true; }
+  template<typename U>
+  bool operator!= (const counting_allocator<U> &) const
+  { return false; }
+};
+
+/** a stand in elem of the traced elem size */
+template<size_t Size>
+struct trace_elem {
+  unsigned char bytes[Size];
+};
+
+/** the replay of a site with one setting */
+struct replay_result {
+  size_t static_capacity;
+  const char *growth;
+  size_t vector_bytes;
+  size_t peak_bytes;
+  uint64_t allocations;
+  double seconds;
+};
+
+/**
+ * runs the ops of site on vectors of type Vector. with Measure, the peak
+ * footprint goes to peak
+ */
+template<class Vector, bool Measure>
+void replay (const vl_trace_site &site, size_t &peak)
+{
+  typedef typename Vector::value_type elem;
+  static std::vector<elem> scratch; // the elems of an insert
+  std::vector<std::unique_ptr<Vector>> objects;
+  size_t live = 0;
+  for (const vl_trace_record &record : site.records)
+    {
+      if (record.op == vl_trace_new)
+        {
+          if (objects.size () <= record.object)
+            objects.resize (record.object + 1);
+          objects[record.object].reset (new Vector);
+          objects[record.object]->resize (record.count);
+          ++live;
+          continue;
+        }
+      if (record.object >= objects.size () || !objects[record.object])
+        continue; // a truncated trace
+      Vector &vec = *objects[record.object];
+      Vector *other = record.pos < objects.size ()
+                      ? objects[record.pos].get () : nullptr;
+      size_t pos = std::min<size_t> (record.pos, vec.size ());
+      switch (record.op)
+        {
+          case vl_trace_push:
+            vec.emplace_back ();
+          break;
+          case vl_trace_insert:
+            if (pos == vec.size ())
+              vec.append_uninitialized (record.count);
+            else
+              {
+                scratch.resize (record.count);
+                vec.insert (vec.begin () + pos, scratch.begin (),
+                            scratch.end ());
+              }
+          break;
+          case vl_trace_erase:
+            vec.erase (vec.begin () + pos, vec.begin ()
+                + std::min<size_t> (pos + record.count, vec.size ()));
+          break;
+          case vl_trace_pop:
+            vec.pop_back ();
+          break;
+          case vl_trace_resize:
+            vec.resize (record.count);
+          break;
+          case vl_trace_reserve:
+            vec.reserve (record.count);
+          break;
+          case vl_trace_shrink:
+            vec.shrink_to_fit ();
+          break;
+          case vl_trace_release:
+            vec = Vector ();
+          break;
+          case vl_trace_take:
+            if (other != nullptr && other != &vec)
+              vec = std::move (*other);
+          break;
+          case vl_trace_swap:
+            if (other != nullptr)
+              vec.swap (*other);
+          break;
+          case vl_trace_destroy:
+            objects[record.object].reset ();
+            --live;
+          break;
+          default:
+            break;
+        }
+      if constexpr (Measure)
+        peak = std::max (peak, live * sizeof (Vector) + counters.bytes);
+    }
+}
+
+/** replays site with one setting, the time is the best of repeat runs */
+template<size_t ElemSize, size_t StaticCapacity, class Growth>
+replay_result replay_setting (const vl_trace_site &site, const char *growth,
+                              int repeat)
+{
+  typedef vl_vector<trace_elem<ElemSize>, StaticCapacity,
+                    vl_shrink_hysteresis<>, Growth,
+                    counting_allocator<trace_elem<ElemSize>>> vector;
+  replay_result result = {StaticCapacity, growth, sizeof (vector), 0, 0, 0};
+  counters = heap_counters ();
+  replay<vector, true> (site, result.peak_bytes);
+  result.allocations = counters.allocations;
+  for (int run = 0; run < repeat; ++run)
+    {
+      size_t unused = 0;
+      auto start = std::chrono::steady_clock::now ();
+      replay<vector, false> (site, unused);
+      std::chrono::duration<double> took = std::chrono::steady_clock::now ()
+                                           - start;
+      if (run == 0 || took.count () < result.seconds)
+        result.seconds = took.count ();
+    }
+  return result;
+}
+
+template<size_t ElemSize, class Growth, size_t... Capacities>
+void replay_capacities (const vl_trace_site &site, const char *growth,
+                        int repeat, std::vector<replay_result> &results,
+                        std::index_sequence<Capacities...>)
+{
+  (results.push_back (replay_setting<ElemSize, Capacities, Growth> (
+      site, growth, repeat)), ...);
+}
+
+typedef std::index_sequence<1, 2, 4, 8, 16, 32, 64, 128, 256> capacities;
+
+template<size_t ElemSize>
+std::vector<replay_result> replay_all (const vl_trace_site &site, int repeat)
+{
+  std::vector<replay_result> results;
+  replay_capacities<ElemSize, vl_growth_1_5x> (site, "1.5x", repeat, results,
+                                               capacities ());
+  replay_capacities<ElemSize, vl_growth_2x> (site, "2x", repeat, results,
+                                             capacities ());
+  return results;
+}
+
+/** replays site with every setting, on elems of about its elem size */
+std::vector<replay_result> replay_site (const vl_trace_site &site, int repeat)
+{
+  size_t size = site.elem_size;
+  if (size <= 1)
+    return replay_all<1> (site, repeat);
+  if (size <= 2)
+    return replay_all<2> (site, repeat);
+  if (size <= 4)
+    return replay_all<4> (site, repeat);
+  if (size <= 8)
+    return replay_all<8> (site, repeat);
+  if (size <= 16)
+    return replay_all<16> (site, repeat);
+  if (size <= 32)
+    return replay_all<32> (site, repeat);
+  if (size <= 64)
+    return replay_all<64> (site, repeat);
+  return replay_all<128> (site, repeat);
+}
+
+/** replay times closer than that to the fastest count as fast enough */
+constexpr double noise_seconds = 1e-4;
+
+/**
+ * the index of the smallest peak footprint among the results within
+ * tolerance (or noise_seconds) of the fastest, fewer allocations break ties
+ */
+size_t recommend (const std::vector<replay_result> &results, double tolerance)
+{
+  double fastest = results[0].seconds;
+  for (const replay_result &result : results)
+    fastest = std::min (fastest, result.seconds);
+  size_t best = results.size ();
+  for (size_t i = 0; i < results.size (); ++i)
+    {
+      const replay_result &result = results[i];
+      if (result.seconds > fastest * (1 + tolerance)
+          && result.seconds > fastest + noise_seconds)
+        continue;
+      if (best == results.size () || result.peak_bytes < results[best].peak_bytes
+          || (result.peak_bytes == results[best].peak_bytes
+              && result.allocations < results[best].allocations))
+        best = i;
+    }
+  return best;
+}
+
+/** the number of vectors in a site's trace */
+size_t vectors_of (const vl_trace_site &site)
+{
+  size_t count = 0;
+  for (const vl_trace_record &record : site.records)
+    count += record.op == vl_trace_new;
+  return count;
+}
+
+void print_text (const vl_trace_site &site,
+                 const std::vector<replay_result> &results, size_t best)
+{
+  std::cout << site.name << "\n  static capacity " << site.static_capacity
+            << ", elem " << site.elem_size << " bytes, " << vectors_of (site)
+            << " vectors, " << site.records.size () << " ops\n"
+            << "  capacity growth vector bytes   peak bytes  allocations"
+               "     time ms\n";
+  for (size_t i = 0; i < results.size (); ++i)
+    {
+      const replay_result &result = results[i];
+      std::cout << "  " << std::setw (8) << result.static_capacity
+                << std::setw (7) << result.growth << std::setw (13)
+                << result.vector_bytes << std::setw (13) << result.peak_bytes
+                << std::setw (13) << result.allocations << std::setw (12)
+                << std::fixed << std::setprecision (3)
+                << result.seconds * 1000
+                << (i == best ? "  <- recommended" : "") << "\n";
+    }
+  std::cout << "  recommended: StaticCapacity " << results[best].static_capacity
+            << ", " << results[best].growth << " growth\n\n";
+}
+
+void print_json (const vl_trace_site &site,
+                 const std::vector<replay_result> &results, size_t best,
+                 bool last)
+{
+  std::cout << "  {\"type\": \"" << site.name << "\", \"static_capacity\": "
+            << site.static_capacity << ", \"elem_size\": " << site.elem_size
+            << ", \"vectors\": " << vectors_of (site) << ", \"ops\": "
+            << site.records.size () << ", \"recommended\": {\"static_capacity\": "
+            << results[best].static_capacity << ", \"growth\": \""
+            << results[best].growth << "\"}, \"settings\": [";
+  for (size_t i = 0; i < results.size (); ++i)
+    {
+      const replay_result &result = results[i];
+      std::cout << (i == 0 ? "" : ", ") << "{\"static_capacity\": "
+                << result.static_capacity << ", \"growth\": \""
+                << result.growth << "\", \"vector_bytes\": "
+                << result.vector_bytes << ", \"peak_bytes\": "
+                << result.peak_bytes << ", \"allocations\": "
+                << result.allocations << ", \"seconds\": " << result.seconds
+                << "}";
+    }
+  std::cout << "]}" << (last ? "" : ",") << "\n";
+}
+
+}
+
+int main (int argc, char **argv)
+{
+  const char *path = nullptr;
+  double tolerance = 0.05;
+  int repeat = 5;
+  bool json = false;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      if (arg == "--tolerance" && i + 1 < argc)
+        tolerance = std::atof (argv[++i]);
+      else if (arg == "--repeat" && i + 1 < argc)
+        repeat = std::max (1, std::atoi (argv[++i]));
+      else if (arg == "--json")
+        json = true;
+      else if (path == nullptr && arg[0] != '-')
+        path = argv[i];
+      else
+        usage = true;
+    }
+  if (path == nullptr || usage)
+    {
+      std::cerr << "usage: vl_capacity_advisor <trace> [--tolerance 0.05] "
+                   "[--repeat 5] [--json]\n";
+      return 2;
+    }
+  std::ifstream in (path);
+  if (!in)
+    {
+      std::cerr << "can't open " << path << "\n";
+      return 1;
+    }
+  std::vector<vl_trace_site> sites;
+  try
+    {
+      sites = vl_trace_read (in);
+    }
+  catch (const std::exception &e)
+    {
+      std::cerr << path << ": " << e.what () << "\n";
+      return 1;
+    }
+  if (json)
+    std::cout << "[\n";
+  for (size_t i = 0; i < sites.size (); ++i)
+    {
+      std::vector<replay_result> results = replay_site (sites[i], repeat);
+      size_t best = recommend (results, tolerance);
+      if (json)
+        print_json (sites[i], results, best, i + 1 == sites.size ());
+      else
+        print_text (sites[i], results, best);
+    }
+  if (json)
+    std::cout << "]\n";
+  return 0;
+}
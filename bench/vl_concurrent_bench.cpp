@@ -0,0 +1,50 @@
+// many threads pushing results into one collection - a vl_vector behind a
+// mutex vs vl_concurrent_vector
+
+#include "../vl_concurrent_vector.h"
+#include "../vl_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+
+namespace {
+
+/** a vl_vector behind a mutex, what the fan-in stage used before */
+class locked_vector {
+ public:
+  void push_back (int value)
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    _vec.push_back (value);
+  }
+
+ private:
+  std::mutex _mutex;
+  vl_vector<int, 16> _vec;
+};
+
+/** every thread pushes range (0) ints per iteration into a shared sink */
+template<class Sink>
+void BM_FanIn (benchmark::State &state)
+{
+  static Sink *sink;
+  if (state.thread_index () == 0)
+    sink = new Sink;
+  const int count = static_cast<int> (state.range (0));
+  for (auto _ : state)
+    for (int i = 0; i < count; ++i)
+      sink->push_back (i);
+  if (state.thread_index () == 0)
+    delete sink;
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+}
+
+BENCHMARK_TEMPLATE (BM_FanIn, locked_vector)
+    ->Arg (64)->ThreadRange (1, 16)->UseRealTime ();
+BENCHMARK_TEMPLATE (BM_FanIn, vl_concurrent_vector<int, 16>)
+    ->Arg (64)->ThreadRange (1, 16)->UseRealTime ();
+
+BENCHMARK_MAIN ();
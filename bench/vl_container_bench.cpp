@@ -0,0 +1,330 @@
+// vl_vector / vl_string against std::vector, boost::small_vector and
+// std::string, for elems of a few sizes, a few static capacities, and sizes on
+// both sides of the static -> heap spill
+
+#include "../vl_intern.h"
+#include "../vl_jagged.h"
+#include "../vl_string.h"
+#include "../vl_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#ifdef VL_BENCH_BOOST
+#include <boost/container/small_vector.hpp>
+#endif
+
+namespace {
+
+/** an elem of Size bytes */
+template<size_t Size>
+struct blob {
+  unsigned char bytes[Size];
+
+  blob () = default;
+  explicit blob (size_t value)
+  { std::memset (bytes, static_cast<int> (value), Size); }
+  bool operator== (const blob &other) const
+  { return std::memcmp (bytes, other.bytes, Size) == 0; }
+};
+
+/** sizes around a static capacity of N - half, full, one spill, far past */
+template<size_t N>
+void spill_args (benchmark::internal::Benchmark *bench)
+{
+  bench->Arg (N / 2)->Arg (N)->Arg (N + 1)->Arg (4 * N)->Arg (1024);
+}
+
+/** builds a container of range (0) elems with push_back */
+template<class Container>
+void BM_PushBack (benchmark::State &state)
+{
+  typedef typename Container::value_type T;
+  const size_t count = static_cast<size_t> (state.range (0));
+  for (auto _ : state)
+    {
+      Container vec;
+      for (size_t i = 0; i < count; ++i)
+        vec.push_back (T (i));
+      benchmark::DoNotOptimize (vec.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** builds a container of range (0) elems by inserting at the front */
+template<class Container>
+void BM_InsertFront (benchmark::State &state)
+{
+  typedef typename Container::value_type T;
+  const size_t count = static_cast<size_t> (state.range (0));
+  for (auto _ : state)
+    {
+      Container vec;
+      for (size_t i = 0; i < count; ++i)
+        vec.insert (vec.begin (), T (i));
+      benchmark::DoNotOptimize (vec.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** empties a container of range (0) elems by erasing at the front */
+template<class Container>
+void BM_EraseFront (benchmark::State &state)
+{
+  typedef typename Container::value_type T;
+  const size_t count = static_cast<size_t> (state.range (0));
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      Container vec;
+      for (size_t i = 0; i < count; ++i)
+        vec.push_back (T (i));
+      state.ResumeTiming ();
+      while (!vec.empty ())
+        vec.erase (vec.begin ());
+      benchmark::DoNotOptimize (vec.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** copies a container of range (0) elems */
+template<class Container>
+void BM_Copy (benchmark::State &state)
+{
+  typedef typename Container::value_type T;
+  const size_t count = static_cast<size_t> (state.range (0));
+  Container src;
+  for (size_t i = 0; i < count; ++i)
+    src.push_back (T (i));
+  for (auto _ : state)
+    {
+      Container copy (src);
+      benchmark::DoNotOptimize (copy.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** copy assigns a container of range (0) elems over one of the same size */
+template<class Container>
+void BM_CopyAssign (benchmark::State &state)
+{
+  typedef typename Container::value_type T;
+  const size_t count = static_cast<size_t> (state.range (0));
+  Container src;
+  for (size_t i = 0; i < count; ++i)
+    src.push_back (T (i));
+  Container dest (src);
+  for (auto _ : state)
+    {
+      dest = src;
+      benchmark::DoNotOptimize (dest.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** sums a container of range (0) ints by index, operator[] in a tight loop */
+template<class Container>
+void BM_IndexedSum (benchmark::State &state)
+{
+  const size_t count = static_cast<size_t> (state.range (0));
+  Container vec;
+  for (size_t i = 0; i < count; ++i)
+    vec.push_back (static_cast<int> (i));
+  for (auto _ : state)
+    {
+      int sum = 0;
+      for (size_t i = 0; i < vec.size (); ++i)
+        sum += vec[i];
+      benchmark::DoNotOptimize (sum);
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** appends range (0) chars to an empty string, 8 at a time */
+template<class String>
+void BM_StringAppend (benchmark::State &state)
+{
+  const size_t count = static_cast<size_t> (state.range (0));
+  for (auto _ : state)
+    {
+      String str;
+      for (size_t i = 0; i < count; i += 8)
+        str += "fragment";
+      benchmark::DoNotOptimize (str.data ());
+    }
+  state.SetBytesProcessed (state.iterations () * count);
+}
+
+/** hashes a range (0) chars key */
+template<class String>
+void BM_StringHash (benchmark::State &state)
+{
+  const size_t count = static_cast<size_t> (state.range (0));
+  String key;
+  for (size_t i = 0; i < count; ++i)
+    key.push_back (static_cast<char> ('a' + i % 26));
+  std::hash<String> hasher;
+  for (auto _ : state)
+    {
+      benchmark::DoNotOptimize (key);
+      benchmark::DoNotOptimize (hasher (key));
+    }
+  state.SetBytesProcessed (state.iterations () * count);
+}
+
+/** appends range (0) chars one by one, then reads the c string */
+template<class String>
+void BM_StringPushBack (benchmark::State &state)
+{
+  const size_t count = static_cast<size_t> (state.range (0));
+  for (auto _ : state)
+    {
+      String str;
+      for (size_t i = 0; i < count; ++i)
+        str.push_back (static_cast<char> ('a' + i % 26));
+      benchmark::DoNotOptimize (str.c_str ());
+    }
+  state.SetBytesProcessed (state.iterations () * count);
+}
+
+/**
+ * counts the tags equal to a probe among 1024 tags of range (0) distinct
+ * names that share a long prefix - vl_strings compare their chars,
+ * vl_interned handles compare one integer
+ */
+template<class Tag>
+void BM_TagMatch (benchmark::State &state)
+{
+  const int distinct = static_cast<int> (state.range (0));
+  vl_intern_pool pool;
+  auto make_tag = [&pool] (int i) {
+    std::string name = "request.header.field_" + std::to_string (i);
+    if constexpr (std::is_same<Tag, vl_interned>::value)
+      return pool.intern (name);
+    else
+      return Tag (name.c_str ());
+  };
+  std::vector<Tag> tags;
+  for (int i = 0; i < 1024; ++i)
+    tags.push_back (make_tag (i % distinct));
+  Tag probe = make_tag (distinct / 2);
+  for (auto _ : state)
+    {
+      size_t matches = 0;
+      for (const Tag &tag : tags)
+        matches += tag == probe;
+      benchmark::DoNotOptimize (matches);
+    }
+  state.SetItemsProcessed (state.iterations () * tags.size ());
+}
+
+/**
+ * sums the neighbours of every node of a graph of range (0) nodes, most of
+ * 3 - 6 edges and one in 32 of 40 - adjacency lists as a vl_jagged, or as a
+ * std::vector of vl_vectors of the same inline capacity
+ */
+template<class Graph>
+void BM_Neighbors (benchmark::State &state)
+{
+  const size_t nodes = static_cast<size_t> (state.range (0));
+  Graph graph;
+  size_t edges = 0;
+  for (size_t node = 0; node < nodes; ++node)
+    {
+      size_t degree = node % 32 == 0 ? 40 : 3 + node % 4;
+      if constexpr (std::is_same<Graph, vl_jagged<uint32_t, 8>>::value)
+        graph.add_row ();
+      else
+        graph.emplace_back ();
+      for (size_t edge = 0; edge < degree; ++edge)
+        graph[node].push_back (
+            static_cast<uint32_t> ((node * 2654435761u + edge) % nodes));
+      edges += degree;
+    }
+  if constexpr (std::is_same<Graph, vl_jagged<uint32_t, 8>>::value)
+    graph.compact ();
+  for (auto _ : state)
+    {
+      uint64_t sum = 0;
+      for (size_t node = 0; node < nodes; ++node)
+        for (uint32_t next : graph[node])
+          sum += next;
+      benchmark::DoNotOptimize (sum);
+    }
+  state.SetItemsProcessed (state.iterations () * edges);
+}
+
+/** a + b + "c" + 'd' of two strings of range (0) chars */
+template<class String>
+void BM_StringConcat (benchmark::State &state)
+{
+  const std::string chars (static_cast<size_t> (state.range (0)), 'x');
+  const String lhs (chars.c_str ());
+  const String rhs (chars.c_str ());
+  for (auto _ : state)
+    {
+      String str = lhs + rhs + ": " + '\n';
+      benchmark::DoNotOptimize (str.data ());
+    }
+}
+
+}
+
+// the same elems and sizes for every container, so their rows line up
+#define VL_CONTAINER_BENCHES(Bench, T, N) \
+  BENCHMARK_TEMPLATE (Bench, std::vector<T>)->Apply (spill_args<N>); \
+  BENCHMARK_TEMPLATE (Bench, vl_vector<T, N>)->Apply (spill_args<N>)
+
+#ifdef VL_BENCH_BOOST
+#define VL_BOOST_BENCHES(Bench, T, N) \
+  BENCHMARK_TEMPLATE (Bench, boost::container::small_vector<T, N>) \
+      ->Apply (spill_args<N>)
+#else
+#define VL_BOOST_BENCHES(Bench, T, N)
+#endif
+
+#define VL_ALL_BENCHES(T, N) \
+  VL_CONTAINER_BENCHES (BM_PushBack, T, N); \
+  VL_BOOST_BENCHES (BM_PushBack, T, N); \
+  VL_CONTAINER_BENCHES (BM_InsertFront, T, N); \
+  VL_BOOST_BENCHES (BM_InsertFront, T, N); \
+  VL_CONTAINER_BENCHES (BM_EraseFront, T, N); \
+  VL_BOOST_BENCHES (BM_EraseFront, T, N); \
+  VL_CONTAINER_BENCHES (BM_Copy, T, N); \
+  VL_BOOST_BENCHES (BM_Copy, T, N); \
+  VL_CONTAINER_BENCHES (BM_CopyAssign, T, N); \
+  VL_BOOST_BENCHES (BM_CopyAssign, T, N)
+
+VL_ALL_BENCHES (blob<4>, 16);
+VL_ALL_BENCHES (blob<4>, 64);
+VL_ALL_BENCHES (blob<32>, 16);
+VL_ALL_BENCHES (blob<256>, 8);
+
+VL_CONTAINER_BENCHES (BM_IndexedSum, int, 16);
+
+BENCHMARK_TEMPLATE (BM_StringAppend, std::string)
+    ->Arg (8)->Arg (16)->Arg (24)->Arg (256)->Arg (4096);
+BENCHMARK_TEMPLATE (BM_StringAppend, vl_string<>)
+    ->Arg (8)->Arg (16)->Arg (24)->Arg (256)->Arg (4096);
+BENCHMARK_TEMPLATE (BM_StringHash, std::string)
+    ->Arg (8)->Arg (23)->Arg (64)->Arg (1024);
+BENCHMARK_TEMPLATE (BM_StringHash, vl_string<>)
+    ->Arg (8)->Arg (23)->Arg (64)->Arg (1024);
+BENCHMARK_TEMPLATE (BM_StringPushBack, std::string)
+    ->Arg (15)->Arg (23)->Arg (256);
+BENCHMARK_TEMPLATE (BM_StringPushBack, vl_string<>)
+    ->Arg (15)->Arg (23)->Arg (256);
+BENCHMARK_TEMPLATE (BM_StringConcat, std::string)
+    ->Arg (4)->Arg (16)->Arg (256);
+BENCHMARK_TEMPLATE (BM_StringConcat, vl_string<>)
+    ->Arg (4)->Arg (16)->Arg (256);
+BENCHMARK_TEMPLATE (BM_TagMatch, vl_string<>)->Arg (16)->Arg (1024);
+BENCHMARK_TEMPLATE (BM_TagMatch, vl_interned)->Arg (16)->Arg (1024);
+BENCHMARK_TEMPLATE (BM_Neighbors, vl_jagged<uint32_t, 8>)
+    ->Arg (1024)->Arg (1 << 16)->Arg (1 << 20);
+BENCHMARK_TEMPLATE (BM_Neighbors, std::vector<vl_vector<uint32_t, 8>>)
+    ->Arg (1024)->Arg (1 << 16)->Arg (1 << 20);
+
+BENCHMARK_MAIN ();
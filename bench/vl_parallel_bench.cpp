@@ -0,0 +1,124 @@
+// the parallel algorithms on a big vl_vector, on pools of 1 to all the cores,
+// next to the serial loop they replace
+
+#include "../vl_parallel.h"
+#include "../vl_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+
+namespace {
+
+const size_t elems = 1 << 22;
+
+/** a pool of range (0) threads, kept for all the benchmarks that use it */
+vl_thread_pool &pool_of (int64_t threads)
+{
+  static std::map<int64_t, std::unique_ptr<vl_thread_pool>> pools;
+  auto &pool = pools[threads];
+  if (!pool)
+    pool.reset (new vl_thread_pool (static_cast<size_t> (threads)));
+  return *pool;
+}
+
+/** the thread counts - 1, powers of two, and all the cores */
+void thread_args (benchmark::internal::Benchmark *bench)
+{
+  int64_t cores = static_cast<int64_t> (vl_thread_pool::default_threads ());
+  for (int64_t threads = 1; threads < cores; threads *= 2)
+    bench->Arg (threads);
+  bench->Arg (cores);
+}
+
+vl_vector<float> random_floats ()
+{
+  std::mt19937 gen (7);
+  std::uniform_real_distribution<float> dist (0.f, 1.f);
+  vl_vector<float> vec;
+  vec.resize_for_overwrite (elems);
+  for (float &elem : vec)
+    elem = dist (gen);
+  return vec;
+}
+
+void BM_Transform (benchmark::State &state)
+{
+  vl_thread_pool &pool = pool_of (state.range (0));
+  vl_vector<float> src = random_floats ();
+  vl_vector<float> dest;
+  dest.resize_for_overwrite (elems);
+  for (auto _ : state)
+    {
+      vl_parallel_transform (src.begin (), src.end (), dest.begin (),
+                             [] (float x) { return std::sqrt (x) * 3.f + 1.f; },
+                             pool);
+      benchmark::DoNotOptimize (dest.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * elems);
+}
+
+void BM_Reduce (benchmark::State &state)
+{
+  vl_thread_pool &pool = pool_of (state.range (0));
+  vl_vector<float> src = random_floats ();
+  for (auto _ : state)
+    benchmark::DoNotOptimize (vl_parallel_reduce (src.begin (), src.end (),
+                                                  0.0, std::plus<> (), pool));
+  state.SetItemsProcessed (state.iterations () * elems);
+}
+
+void BM_Find (benchmark::State &state)
+{
+  vl_thread_pool &pool = pool_of (state.range (0));
+  vl_vector<float> src = random_floats ();
+  for (auto _ : state)
+    benchmark::DoNotOptimize (vl_parallel_find (src.begin (), src.end (), 2.f,
+                                                pool));
+  state.SetItemsProcessed (state.iterations () * elems);
+}
+
+void BM_Sort (benchmark::State &state)
+{
+  vl_thread_pool &pool = pool_of (state.range (0));
+  vl_vector<float> src = random_floats ();
+  vl_vector<float> vec;
+  for (auto _ : state)
+    {
+      state.PauseTiming ();
+      vec = src;
+      state.ResumeTiming ();
+      vl_parallel_sort (vec.begin (), vec.end (), std::less<> (), pool);
+      benchmark::DoNotOptimize (vec.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * elems);
+}
+
+/** a vector in its static array - it must run inline on any pool */
+void BM_SmallForInline (benchmark::State &state)
+{
+  vl_thread_pool &pool = pool_of (state.range (0));
+  vl_vector<int, 16> vec;
+  vec.resize (16);
+  for (auto _ : state)
+    {
+      vl_parallel_for (vec.begin (), vec.end (), [] (int &x) { ++x; }, pool);
+      benchmark::DoNotOptimize (vec.data ());
+    }
+}
+
+}
+
+BENCHMARK (BM_Transform)->Apply (thread_args)->UseRealTime ();
+BENCHMARK (BM_Reduce)->Apply (thread_args)->UseRealTime ();
+BENCHMARK (BM_Find)->Apply (thread_args)->UseRealTime ();
+BENCHMARK (BM_Sort)->Apply (thread_args)->UseRealTime ();
+BENCHMARK (BM_SmallForInline)->Apply (thread_args);
+
+BENCHMARK_MAIN ();
@@ -0,0 +1,76 @@
+// global new vs vl_pool / vl_arena for short lived vectors that spill out
+// of their static array
+
+#include "../vl_allocator.h"
+#include "../vl_string.h"
+#include "../vl_vector.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+template<class Allocator>
+using spill_vector = vl_vector<int, 8, vl_shrink_hysteresis<>,
+                               vl_growth_1_5x, Allocator>;
+
+/** builds and drops a vector of range (0) ints, spilling past 8 elems */
+template<class Allocator>
+void BM_SpillVector (benchmark::State &state)
+{
+  const int count = static_cast<int> (state.range (0));
+  for (auto _ : state)
+    {
+      spill_vector<Allocator> vec;
+      for (int i = 0; i < count; ++i)
+        vec.push_back (i);
+      benchmark::DoNotOptimize (vec.data ());
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** same, but the vectors of every "request" come from an arena reset after */
+void BM_SpillVectorArena (benchmark::State &state)
+{
+  const int count = static_cast<int> (state.range (0));
+  vl_arena arena;
+  vl_arena_scope scope (arena);
+  for (auto _ : state)
+    {
+      {
+        spill_vector<vl_arena_allocator<int>> vec;
+        for (int i = 0; i < count; ++i)
+          vec.push_back (i);
+        benchmark::DoNotOptimize (vec.data ());
+      }
+      arena.reset ();
+    }
+  state.SetItemsProcessed (state.iterations () * count);
+}
+
+/** concatenates strings that outgrow their static array */
+template<class Allocator>
+void BM_SpillString (benchmark::State &state)
+{
+  for (auto _ : state)
+    {
+      vl_string<16, Allocator> str ("request: ");
+      for (int i = 0; i < 8; ++i)
+        str += "some header field, ";
+      benchmark::DoNotOptimize (str.data ());
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE (BM_SpillVector, std::allocator<int>)
+    ->Arg (64)->Arg (1024)->ThreadRange (1, 32)->UseRealTime ();
+BENCHMARK_TEMPLATE (BM_SpillVector, vl_pool_allocator<int>)
+    ->Arg (64)->Arg (1024)->ThreadRange (1, 32)->UseRealTime ();
+BENCHMARK (BM_SpillVectorArena)
+    ->Arg (64)->Arg (1024)->ThreadRange (1, 32)->UseRealTime ();
+BENCHMARK_TEMPLATE (BM_SpillString, std::allocator<char>)
+    ->ThreadRange (1, 32)->UseRealTime ();
+BENCHMARK_TEMPLATE (BM_SpillString, vl_pool_allocator<char>)
+    ->ThreadRange (1, 32)->UseRealTime ();
+
+BENCHMARK_MAIN ();
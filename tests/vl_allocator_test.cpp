@@ -0,0 +1,120 @@
+#include "vl_allocator.h"
+#include "vl_string.h"
+#include "vl_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace {
+
+template<class Allocator>
+using int_vector = vl_vector<int, 4, vl_shrink_hysteresis<>, vl_growth_1_5x,
+                             Allocator>;
+
+template<class Vector>
+void fill_and_check (Vector &vec, int count)
+{
+  for (int i = 0; i < count; ++i)
+    vec.push_back (i);
+  ASSERT_EQ (vec.size (), static_cast<size_t> (count));
+  for (int i = 0; i < count; ++i)
+    ASSERT_EQ (vec[i], i);
+}
+
+}
+
+TEST (VlAllocator, MallocAllocator)
+{
+  // malloc can't grow a block in place, only realloc can
+  static_assert (!vl_has_try_expand<vl_malloc_allocator<int>>::value);
+  static_assert (vl_has_reallocate<vl_malloc_allocator<int>>::value);
+  int_vector<vl_malloc_allocator<int>> vec;
+  fill_and_check (vec, 1000);
+  vec.erase (vec.begin () + 10, vec.end ());
+  EXPECT_EQ (vec.size (), 10u);
+}
+
+TEST (VlAllocator, PoolAllocator)
+{
+  int_vector<vl_pool_allocator<int>> vec;
+  fill_and_check (vec, 1000);
+  vl_string<16, vl_pool_allocator<char>> text ("pooled");
+  for (int i = 0; i < 10; ++i)
+    text += " string";
+  EXPECT_EQ (text.size (), 76u);
+}
+
+TEST (VlAllocator, PoolReusesFreedBlocks)
+{
+  void *block = vl_pool::allocate (100);
+  vl_pool::deallocate (block, 100);
+  EXPECT_EQ (vl_pool::allocate (120), block);
+  vl_pool::deallocate (block, 120);
+  EXPECT_EQ (vl_pool::block_size (100), 128u);
+}
+
+TEST (VlAllocator, PoolAcrossThreads)
+{
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back ([]
+                          {
+                            for (int round = 0; round < 100; ++round)
+                              {
+                                int_vector<vl_pool_allocator<int>> vec;
+                                fill_and_check (vec, 300);
+                              }
+                          });
+  for (auto &thread : threads)
+    thread.join ();
+}
+
+TEST (VlAllocator, Arena)
+{
+  vl_arena arena (1024);
+  void *first = arena.allocate (100, 8);
+  void *second = arena.allocate (100, 8);
+  EXPECT_EQ (static_cast<char *> (second) - static_cast<char *> (first),
+             104);
+  EXPECT_TRUE (arena.try_expand (second, 100, 200));
+  EXPECT_FALSE (arena.try_expand (first, 100, 200));
+  arena.allocate (5000, 16);
+  arena.reset ();
+  EXPECT_EQ (arena.bytes_used (), 0u);
+}
+
+TEST (VlAllocator, ArenaAlignsNearChunkEnd)
+{
+  // aligning the second block steps past the end of the first chunk, it
+  // must go to a new one
+  vl_arena arena (64);
+  char *first = static_cast<char *> (arena.allocate (60, 1));
+  std::memset (first, 1, 60);
+  char *second = static_cast<char *> (arena.allocate (8, 64));
+  EXPECT_EQ (reinterpret_cast<uintptr_t> (second) % 64, 0u);
+  EXPECT_TRUE (second + 8 <= first || second >= first + 60);
+  std::memset (second, 2, 8);
+  char *third = static_cast<char *> (arena.allocate (100, 128));
+  EXPECT_EQ (reinterpret_cast<uintptr_t> (third) % 128, 0u);
+  std::memset (third, 3, 100);
+  EXPECT_EQ (first[59], 1);
+  EXPECT_EQ (second[7], 2);
+}
+
+TEST (VlAllocator, ArenaScope)
+{
+  vl_arena arena;
+  EXPECT_EQ (vl_arena::current (), nullptr);
+  {
+    vl_arena_scope scope (arena);
+    EXPECT_EQ (vl_arena::current (), &arena);
+    int_vector<vl_arena_allocator<int>> vec;
+    EXPECT_EQ (vec.get_allocator ().arena (), &arena);
+    fill_and_check (vec, 500);
+    EXPECT_GT (arena.bytes_used (), 0u);
+  }
+  EXPECT_EQ (vl_arena::current (), nullptr);
+  int_vector<vl_arena_allocator<int>> heap_vec;
+  fill_and_check (heap_vec, 100);
+}
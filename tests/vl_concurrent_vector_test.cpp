@@ -0,0 +1,67 @@
+#include "vl_concurrent_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST (VlConcurrentVector, PushBackKeepsElemsInPlace)
+{
+  vl_concurrent_vector<int, 4> vec;
+  EXPECT_EQ (vec.capacity (), 4u);
+  int *first = &vec.emplace_back (0);
+  for (int i = 1; i < 100; ++i)
+    EXPECT_EQ (vec.push_back (i), static_cast<size_t> (i));
+  EXPECT_EQ (first, &vec[0]);
+  EXPECT_EQ (vec.size (), 100u);
+  EXPECT_GE (vec.capacity (), 100u);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ (vec[i], i);
+  EXPECT_THROW (vec.at (100), std::out_of_range);
+}
+
+TEST (VlConcurrentVector, GrowBy)
+{
+  vl_concurrent_vector<std::string, 2> vec;
+  vec.push_back ("head");
+  EXPECT_EQ (vec.grow_by (5, std::string ("x")), 1u);
+  std::vector<std::string> more{"a", "b", "c"};
+  EXPECT_EQ (vec.grow_by (more.begin (), more.end ()), 6u);
+  std::vector<std::string> all (vec.begin (), vec.end ());
+  EXPECT_EQ (all, (std::vector<std::string>{"head", "x", "x", "x", "x", "x",
+                                            "a", "b", "c"}));
+  size_t runs = 0;
+  size_t seen = 0;
+  vec.for_each_segment ([&] (std::string *, size_t count)
+                        {
+                          ++runs;
+                          seen += count;
+                        });
+  EXPECT_EQ (seen, 9u);
+  EXPECT_EQ (runs, 4u); // 2 static, then 2 and 4 on the heap, 1 in the last
+  vec.clear ();
+  EXPECT_TRUE (vec.empty ());
+}
+
+TEST (VlConcurrentVector, ManyThreadsPush)
+{
+  const int threads = 8;
+  const int per_thread = 20000;
+  vl_concurrent_vector<int, 16> vec;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back ([&vec, t]
+                          {
+                            for (int i = 0; i < per_thread; ++i)
+                              vec.push_back (t * per_thread + i);
+                          });
+  for (auto &worker : workers)
+    worker.join ();
+  ASSERT_EQ (vec.size (), static_cast<size_t> (threads * per_thread));
+  std::vector<int> all (vec.begin (), vec.end ());
+  std::sort (all.begin (), all.end ());
+  for (int i = 0; i < threads * per_thread; ++i)
+    ASSERT_EQ (all[i], i);
+}
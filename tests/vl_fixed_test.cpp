@@ -0,0 +1,109 @@
+#include "vl_fixed.h"
+#include "vl_intern.h"
+#include "vl_string.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+constexpr vl_fixed_vector<vl_fixed_string<8>, 8> keywords{
+    "if", "else", "while", "for", "return"};
+
+/** squares built by a constexpr function, not at startup */
+constexpr vl_fixed_vector<int, 16> squares ()
+{
+  vl_fixed_vector<int, 16> table;
+  for (int i = 0; i < 10; ++i)
+    table.push_back (i * i);
+  table.insert (table.begin (), -1);
+  table.erase (table.begin () + 3);
+  table.pop_back ();
+  return table;
+}
+
+constexpr vl_fixed_string<32> joined ()
+{
+  vl_fixed_string<32> str ("key");
+  str += '_';
+  str += "value";
+  return str;
+}
+
+}
+
+TEST (VlFixed, ConstantTables)
+{
+  // all checked by the compiler
+  static_assert (keywords.size () == 5);
+  static_assert (keywords.contains ("while"));
+  static_assert (!keywords.contains ("whil"));
+  static_assert (keywords.find ("for") == keywords.begin () + 3);
+  static_assert (keywords[4] == "return");
+
+  constexpr vl_fixed_vector<int, 16> table = squares ();
+  static_assert (table.size () == 9);
+  static_assert (table[0] == -1 && table[1] == 0 && table[3] == 9);
+  static_assert (table.back () == 64);
+  static_assert (table.contains (49) && !table.contains (4));
+  static_assert (table.count (0) == 1);
+
+  constexpr vl_fixed_string<32> str = joined ();
+  static_assert (str == "key_value");
+  static_assert (str.size () == 9);
+  static_assert (str.starts_with ("key") && str.ends_with ("value"));
+  static_assert (str.find ('_') == 3);
+  static_assert (str.contains ("y_v"));
+  static_assert (vl_fixed_string ("abc") < vl_fixed_string ("abd"));
+  static_assert (vl_fixed_string ("abc") != str);
+  static_assert (str.c_str ()[str.size ()] == '\0');
+
+  EXPECT_EQ (keywords.find ("else") - keywords.begin (), 1);
+  EXPECT_STREQ (str.c_str (), "key_value");
+}
+
+TEST (VlFixed, Runtime)
+{
+  vl_fixed_vector<int, 3> vec{1, 2};
+  vec.push_back (3);
+  EXPECT_THROW (vec.push_back (4), std::length_error);
+  EXPECT_THROW (vec.insert (vec.begin (), 0), std::length_error);
+  EXPECT_THROW (vec.at (3), std::out_of_range);
+  vec.erase (vec.begin (), vec.begin () + 2);
+  EXPECT_EQ (vec.size (), 1u);
+  EXPECT_EQ (vec[0], 3);
+  vec.insert (vec.begin (), vec[0]);
+  EXPECT_TRUE ((vec == vl_fixed_vector<int, 3>{3, 3}));
+  vec.clear ();
+  EXPECT_TRUE (vec.empty ());
+
+  vl_fixed_string<4> str ("abcd");
+  EXPECT_THROW (str.push_back ('e'), std::length_error);
+  EXPECT_THROW (vl_fixed_string<2> (std::string_view ("abc")),
+                std::length_error);
+  str.pop_back ();
+  EXPECT_EQ (str.sv (), "abc");
+  EXPECT_TRUE ("abc" == str);
+  EXPECT_LT (str.compare ("abd"), 0);
+}
+
+TEST (VlFixed, WithStrings)
+{
+  // the same hash and lookups as the same chars in a vl_string
+  constexpr vl_fixed_string<16> name ("a_field_name");
+  vl_string<> copy (name);
+  EXPECT_EQ (copy.sv (), name.sv ());
+  EXPECT_EQ (std::hash<vl_fixed_string<16>> () (name),
+             std::hash<vl_string<>> () (copy));
+  EXPECT_EQ (vl_string_hash () (name), vl_string_hash () (copy));
+  EXPECT_TRUE (vl_string_equal () (name, copy));
+
+  std::unordered_set<vl_fixed_string<8>> set (keywords.begin (),
+                                              keywords.end ());
+  EXPECT_EQ (set.count ("return"), 1u);
+
+  vl_intern_pool pool;
+  EXPECT_EQ (pool.intern (name), pool.intern ("a_field_name"));
+}
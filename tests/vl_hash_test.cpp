@@ -0,0 +1,163 @@
+#include "vl_string.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+TEST (VlHash, Bytes)
+{
+  std::string text (300, '\0');
+  for (size_t i = 0; i < text.size (); ++i)
+    text[i] = static_cast<char> (i * 7 + 1);
+  // every length of the prefixes, through all the short / long key paths
+  std::set<uint64_t> hashes;
+  for (size_t len = 0; len <= text.size (); ++len)
+    hashes.insert (vl_hash_bytes (text.data (), len));
+  EXPECT_EQ (hashes.size (), text.size () + 1);
+  // the same bytes anywhere in memory hash the same
+  std::string shifted = "x" + text;
+  EXPECT_EQ (vl_hash_bytes (shifted.data () + 1, 100),
+             vl_hash_bytes (text.data (), 100));
+  EXPECT_NE (vl_hash_bytes (text.data (), 100, 1),
+             vl_hash_bytes (text.data (), 100));
+  // one flipped bit anywhere changes it
+  uint64_t hash = vl_hash_bytes (text.data (), text.size ());
+  for (size_t i = 0; i < text.size (); i += 13)
+    {
+      text[i] ^= 4;
+      EXPECT_NE (vl_hash_bytes (text.data (), text.size ()), hash);
+      text[i] ^= 4;
+    }
+}
+
+TEST (VlHash, VectorHashAndOrder)
+{
+  std::unordered_set<vl_vector<int, 4>> set;
+  for (int len = 0; len < 20; ++len)
+    {
+      vl_vector<int, 4> vec;
+      for (int i = 0; i < len; ++i)
+        vec.push_back (i);
+      set.insert (vec);
+      set.insert (vec);
+    }
+  EXPECT_EQ (set.size (), 20u);
+  vl_vector<int, 4> probe;
+  probe.push_back (0);
+  probe.push_back (1);
+  EXPECT_EQ (set.count (probe), 1u);
+
+  // equal floats with different bytes hash the same
+  vl_vector<float, 2> zero (size_t (3), 0.0f);
+  vl_vector<float, 2> negative_zero (size_t (3), -0.0f);
+  EXPECT_TRUE (zero == negative_zero);
+  std::hash<vl_vector<float, 2>> float_hasher;
+  EXPECT_EQ (float_hasher (zero), float_hasher (negative_zero));
+
+  // the order of std::vector, for signed and unsigned bytes and ints
+  std::mt19937 gen (7);
+  std::uniform_int_distribution<int> value (-3, 3);
+  std::uniform_int_distribution<int> len (0, 6);
+  for (int round = 0; round < 500; ++round)
+    {
+      std::vector<signed char> a (len (gen));
+      std::vector<signed char> b (len (gen));
+      std::generate (a.begin (), a.end (), [&] { return value (gen); });
+      std::generate (b.begin (), b.end (), [&] { return value (gen); });
+      vl_vector<signed char, 3> vl_a (a.begin (), a.end ());
+      vl_vector<signed char, 3> vl_b (b.begin (), b.end ());
+      EXPECT_EQ (vl_a < vl_b, a < b);
+      EXPECT_EQ (vl_a >= vl_b, a >= b);
+      vl_vector<unsigned char, 3> u_a (a.begin (), a.end ());
+      vl_vector<unsigned char, 3> u_b (b.begin (), b.end ());
+      std::vector<unsigned char> ref_a (a.begin (), a.end ());
+      std::vector<unsigned char> ref_b (b.begin (), b.end ());
+      EXPECT_EQ (u_a < u_b, ref_a < ref_b);
+      EXPECT_EQ (u_a <= u_b, ref_a <= ref_b);
+      vl_vector<int, 3> i_a (a.begin (), a.end ());
+      vl_vector<int, 3> i_b (b.begin (), b.end ());
+      EXPECT_EQ (i_a > i_b, a > b);
+    }
+}
+
+TEST (VlHash, StringHashAndOrder)
+{
+  vl_string<4> text ("a key that is long enough to be on the heap");
+  vl_string<> same (text.sv ());
+  vl_string_hash hasher;
+  EXPECT_EQ (std::hash<vl_string<4>> () (text), hasher (text));
+  EXPECT_EQ (hasher (text), hasher (same));
+  EXPECT_EQ (hasher (text), hasher (text.c_str ()));
+  EXPECT_EQ (hasher (text), hasher (std::string (text.sv ())));
+  EXPECT_NE (hasher (text), hasher (text.substr (1)));
+
+  vl_string<> a ("apple");
+  vl_string<> b ("apples");
+  vl_string<> high ("\xff");
+  EXPECT_TRUE (a < b);
+  EXPECT_TRUE (b > a);
+  EXPECT_TRUE (a <= "apple");
+  EXPECT_TRUE ("apple" >= a);
+  EXPECT_TRUE ("zebra" > b);
+  EXPECT_TRUE (a < high); // chars compare as unsigned, like std::string
+  EXPECT_EQ (a.compare (same), std::string ("apple").compare (same.c_str ()));
+  EXPECT_EQ (a.compare ("apple"), 0);
+}
+
+TEST (VlHash, TransparentLookup)
+{
+  std::map<vl_string<>, int, vl_string_less> map;
+  map["alpha"] = 1;
+  map["beta"] = 2;
+  map[vl_string<> ("a gamma that does not fit inline")] = 3;
+  EXPECT_EQ (map.find ("beta")->second, 2);
+  EXPECT_EQ (map.find (std::string_view ("alpha"))->second, 1);
+  EXPECT_EQ (map.find (std::string ("a gamma that does not fit inline"))
+                 ->second, 3);
+  EXPECT_EQ (map.find ("delta"), map.end ());
+
+  std::unordered_map<vl_string<>, int, vl_string_hash, vl_string_equal> hash;
+  hash["alpha"] = 1;
+  EXPECT_EQ (hash.at ("alpha"), 1);
+  vl_string_equal equal;
+  EXPECT_TRUE (equal (vl_string<> ("alpha"), std::string_view ("alpha")));
+  EXPECT_FALSE (equal ("alpha", vl_string<8> ("alphabet")));
+}
+
+TEST (VlHash, HashedString)
+{
+  vl_hashed_string<> key ("symbol");
+  vl_string_hash hasher;
+  EXPECT_EQ (key.hash (), hasher ("symbol"));
+  EXPECT_EQ (hasher (key), key.hash ());
+  key += "_table";
+  EXPECT_EQ (key.hash (), hasher ("symbol_table"));
+  key.edit ().insert (key.edit ().begin (), '_');
+  EXPECT_EQ (key.sv (), "_symbol_table");
+  EXPECT_EQ (key.hash (), hasher ("_symbol_table"));
+  key.resize (3);
+  EXPECT_EQ (key.hash (), hasher ("_sy"));
+
+  vl_hashed_string<> moved (std::move (key));
+  EXPECT_TRUE (key.empty ());
+  EXPECT_EQ (key.hash (), hasher (""));
+  EXPECT_EQ (moved.hash (), hasher ("_sy"));
+  EXPECT_TRUE (moved == "_sy");
+  EXPECT_TRUE (moved != "_sx");
+
+  std::unordered_map<vl_hashed_string<>, int> symbols;
+  for (int i = 0; i < 100; ++i)
+    symbols[vl_hashed_string<> (std::to_string (i))] = i;
+  vl_hashed_string<> probe ("42");
+  EXPECT_EQ (symbols.at (probe), 42);
+  probe = "99";
+  EXPECT_EQ (symbols.at (probe), 99);
+}
@@ -0,0 +1,103 @@
+#include "vl_intern.h"
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST (VlIntern, HandlesAndViews)
+{
+  vl_intern_pool pool;
+  EXPECT_EQ (sizeof (vl_interned), 4u);
+  EXPECT_FALSE (vl_interned ().valid ());
+  vl_interned color = pool.intern ("color");
+  vl_interned size = pool.intern (vl_string<> ("size"));
+  EXPECT_TRUE (color.valid ());
+  EXPECT_NE (color, size);
+  EXPECT_EQ (pool.intern (std::string ("color")), color);
+  EXPECT_EQ (pool.size (), 2u);
+  EXPECT_EQ (pool.view (color), "color");
+  EXPECT_STREQ (pool.c_str (size), "size");
+  EXPECT_EQ (pool.bytes_used (), 11u);
+
+  // the views of a string are the same chars
+  std::string_view view = pool.intern_view ("color");
+  EXPECT_EQ (view.data (), pool.view (color).data ());
+  EXPECT_EQ (pool.find ("size"), size);
+  EXPECT_FALSE (pool.find ("weight").valid ());
+  EXPECT_EQ (pool.size (), 2u);
+  EXPECT_EQ (pool.view (pool.intern ("")), "");
+}
+
+TEST (VlIntern, ManyStrings)
+{
+  vl_intern_pool pool;
+  std::vector<vl_interned> handles;
+  std::vector<const char *> chars;
+  for (int i = 0; i < 5000; ++i)
+    {
+      handles.push_back (pool.intern ("tag_" + std::to_string (i)));
+      chars.push_back (pool.view (handles.back ()).data ());
+    }
+  EXPECT_EQ (pool.size (), 5000u);
+  for (int i = 0; i < 5000; ++i)
+    {
+      std::string tag = "tag_" + std::to_string (i);
+      EXPECT_EQ (pool.intern (tag), handles[i]);
+      // the chars didn't move while the tables grew
+      EXPECT_EQ (pool.view (handles[i]).data (), chars[i]);
+      EXPECT_EQ (pool.view (handles[i]), tag);
+    }
+}
+
+TEST (VlIntern, Bulk)
+{
+  vl_intern_pool pool;
+  vl_interned red = pool.intern ("red");
+  std::vector<vl_interned> handles;
+  pool.intern_split ("red,green,,blue,green,red", ',',
+                     std::back_inserter (handles));
+  ASSERT_EQ (handles.size (), 6u);
+  EXPECT_EQ (handles[0], red);
+  EXPECT_EQ (handles[5], red);
+  EXPECT_EQ (handles[1], handles[4]);
+  EXPECT_EQ (pool.view (handles[2]), "");
+  EXPECT_EQ (pool.view (handles[3]), "blue");
+  EXPECT_EQ (pool.size (), 4u);
+
+  std::vector<vl_string<>> names{"green", "a name too long for the object"};
+  vl_interned out[2];
+  EXPECT_EQ (pool.intern_all (names.begin (), names.end (), out), out + 2);
+  EXPECT_EQ (out[0], handles[1]);
+  EXPECT_EQ (pool.view (out[1]), names[1].sv ());
+}
+
+TEST (VlIntern, Threads)
+{
+  vl_intern_pool pool;
+  const int threads = 8;
+  const int strings = 2000;
+  std::vector<std::vector<vl_interned>> results (threads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back ([&pool, &results, t, strings] {
+      // every thread interns the same strings, in its own order
+      for (int i = 0; i < strings; ++i)
+        {
+          int n = (i * 7 + t * 13) % strings;
+          results[t].push_back (pool.intern ("s" + std::to_string (n)));
+        }
+    });
+  for (std::thread &worker : workers)
+    worker.join ();
+  EXPECT_EQ (pool.size (), static_cast<size_t> (strings));
+  for (int t = 0; t < threads; ++t)
+    for (int i = 0; i < strings; ++i)
+      {
+        int n = (i * 7 + t * 13) % strings;
+        EXPECT_EQ (results[t][i], pool.find ("s" + std::to_string (n)));
+        EXPECT_EQ (pool.view (results[t][i]), "s" + std::to_string (n));
+      }
+}
@@ -0,0 +1,153 @@
+#include "vl_jagged.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+TEST (VlJagged, InlineRows)
+{
+  vl_jagged<uint32_t, 4> rows;
+  EXPECT_TRUE (rows.empty ());
+  EXPECT_EQ (rows.add_row (), 0u);
+  EXPECT_EQ (rows.add_row (), 1u);
+  rows[0].push_back (7);
+  rows[0].push_back (8);
+  rows[1].push_back (9);
+  EXPECT_EQ (rows.size (), 2u);
+  EXPECT_EQ (rows[0].size (), 2u);
+  EXPECT_EQ (rows[0].capacity (), 4u);
+  EXPECT_EQ (rows[0][1], 8u);
+  EXPECT_EQ (rows[1].front (), 9u);
+  EXPECT_TRUE (rows[0].contains (7));
+  EXPECT_FALSE (rows[1].contains (7));
+  EXPECT_EQ (rows[0].find (8), rows[0].begin () + 1);
+  EXPECT_EQ (rows[0].count (8), 1u);
+  EXPECT_THROW (rows[0].at (2), std::out_of_range);
+  EXPECT_THROW (rows.at (2), std::out_of_range);
+  // inline rows are neighbours in memory
+  EXPECT_EQ (rows[1].data (), rows[0].data () + 4);
+  EXPECT_EQ (rows.spilled_rows (), 0u);
+
+  const vl_jagged<uint32_t, 4> &view = rows;
+  vl_jagged<uint32_t, 4>::const_row_type row = rows[0];
+  EXPECT_EQ (row.as_span ().size (), 2u);
+  uint32_t sum = 0;
+  for (uint32_t value : view[0])
+    sum += value;
+  EXPECT_EQ (sum, 15u);
+}
+
+TEST (VlJagged, SpillAndCompact)
+{
+  vl_jagged<int, 2> rows (3);
+  for (int i = 0; i < 10; ++i)
+    rows[1].push_back (i);
+  rows[0].push_back (-1);
+  rows[2].push_back (20);
+  rows[2].push_back (21);
+  rows[2].push_back (22);
+  EXPECT_TRUE (rows[1].spilled ());
+  EXPECT_TRUE (rows[2].spilled ());
+  EXPECT_FALSE (rows[0].spilled ());
+  EXPECT_EQ (rows.spilled_rows (), 2u);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ (rows[1][i], i);
+  EXPECT_EQ (rows[2].back (), 22);
+
+  // a row may take an elem of its own
+  rows[2].push_back (rows[2][0]);
+  EXPECT_EQ (rows[2][3], 20);
+
+  rows[1].erase (rows[1].begin ());
+  rows[1].pop_back ();
+  EXPECT_EQ (rows[1].size (), 8u);
+  EXPECT_EQ (rows[1][0], 1);
+  rows[2].clear ();
+  rows[2].push_back (5);
+  rows.compact ();
+  EXPECT_FALSE (rows[2].spilled ());
+  EXPECT_EQ (rows[2].size (), 1u);
+  EXPECT_EQ (rows[2][0], 5);
+  EXPECT_TRUE (rows[1].spilled ());
+  EXPECT_EQ (rows.overflow_size (), 8u);
+  EXPECT_EQ (rows.overflow_used (), 8u);
+  for (int i = 0; i < 8; ++i)
+    EXPECT_EQ (rows[1][i], i + 1);
+  EXPECT_EQ (rows[0][0], -1);
+}
+
+TEST (VlJagged, AddRowAndResize)
+{
+  std::vector<int> long_row (50, 3);
+  vl_jagged<int, 8> rows;
+  rows.reserve (4);
+  size_t row = rows.add_row (long_row.begin (), long_row.end ());
+  EXPECT_EQ (rows[row].size (), 50u);
+  EXPECT_EQ (rows[row].capacity (), 50u);
+  EXPECT_EQ (rows.overflow_size (), 50u);
+  int short_row[] = {1, 2, 3};
+  row = rows.add_row (short_row, short_row + 3);
+  EXPECT_FALSE (rows[row].spilled ());
+  // just past the inline slots, the block is still of the row's size
+  std::vector<int> nine (9, 4);
+  size_t nine_row = rows.add_row (nine.begin (), nine.end ());
+  EXPECT_EQ (rows[nine_row].capacity (), 9u);
+  EXPECT_EQ (rows.overflow_size (), 59u);
+  EXPECT_EQ (rows[row][2], 3);
+
+  rows.resize (5);
+  EXPECT_EQ (rows.size (), 5u);
+  EXPECT_TRUE (rows[4].empty ());
+  rows.resize (1);
+  EXPECT_EQ (rows.size (), 1u);
+  EXPECT_EQ (rows[0].size (), 50u);
+  rows.clear ();
+  EXPECT_TRUE (rows.empty ());
+  EXPECT_EQ (rows.overflow_size (), 0u);
+}
+
+TEST (VlJagged, RandomRows)
+{
+  // against a vector of vectors, with spills, erases and compactions
+  std::mt19937 gen (11);
+  std::uniform_int_distribution<int> pick (0, 99);
+  vl_jagged<uint16_t, 3> rows;
+  std::vector<std::vector<uint16_t>> ref;
+  for (int step = 0; step < 20000; ++step)
+    {
+      int op = pick (gen);
+      if (op < 5 || ref.empty ())
+        {
+          rows.add_row ();
+          ref.emplace_back ();
+          continue;
+        }
+      size_t row = pick (gen) % ref.size ();
+      if (op < 80)
+        {
+          uint16_t value = static_cast<uint16_t> (pick (gen));
+          rows[row].push_back (value);
+          ref[row].push_back (value);
+        }
+      else if (op < 95 && !ref[row].empty ())
+        {
+          size_t index = pick (gen) % ref[row].size ();
+          rows[row].erase (rows[row].begin () + index);
+          ref[row].erase (ref[row].begin () + index);
+        }
+      else if (op == 99)
+        rows.compact ();
+    }
+  ASSERT_EQ (rows.size (), ref.size ());
+  for (size_t row = 0; row < ref.size (); ++row)
+    ASSERT_EQ (std::vector<uint16_t> (rows[row].begin (), rows[row].end ()),
+               ref[row]);
+  rows.compact ();
+  EXPECT_LE (rows.overflow_used (), rows.overflow_size ());
+  for (size_t row = 0; row < ref.size (); ++row)
+    ASSERT_EQ (std::vector<uint16_t> (rows[row].begin (), rows[row].end ()),
+               ref[row]);
+}
@@ -0,0 +1,124 @@
+#include "vl_parallel.h"
+#include "vl_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const size_t big = 5 * vl_parallel_min + 123;
+
+vl_vector<int> iota_vector (size_t count)
+{
+  vl_vector<int> vec;
+  vec.resize (count);
+  for (size_t i = 0; i < count; ++i)
+    vec[i] = static_cast<int> (i);
+  return vec;
+}
+
+}
+
+TEST (VlParallel, ForAndTransform)
+{
+  vl_thread_pool pool (4);
+  vl_vector<int> vec = iota_vector (big);
+  vl_parallel_for (vec.begin (), vec.end (), [] (int &elem) { elem *= 2; },
+                   pool);
+  vl_vector<long> out;
+  out.resize (big);
+  vl_parallel_transform (vec.begin (), vec.end (), out.begin (),
+                         [] (int elem) { return elem + 1L; }, pool);
+  for (size_t i = 0; i < big; ++i)
+    ASSERT_EQ (out[i], 2L * static_cast<long> (i) + 1);
+}
+
+TEST (VlParallel, Reduce)
+{
+  vl_thread_pool pool (4);
+  vl_vector<int> vec = iota_vector (big);
+  int64_t sum = vl_parallel_reduce (vec.begin (), vec.end (), int64_t (5),
+                                    std::plus<> (), pool);
+  EXPECT_EQ (sum, 5 + static_cast<int64_t> (big) * (big - 1) / 2);
+  // not commutative - the chunks must be combined in order
+  vl_vector<std::string> words;
+  for (size_t i = 0; i < big; ++i)
+    words.push_back (std::string (1, static_cast<char> ('a' + i % 26)));
+  std::string joined = vl_parallel_reduce (words.begin (), words.end (),
+                                           std::string (), std::plus<> (),
+                                           pool);
+  ASSERT_EQ (joined.size (), big);
+  for (size_t i = 0; i < big; ++i)
+    ASSERT_EQ (joined[i], static_cast<char> ('a' + i % 26));
+}
+
+TEST (VlParallel, FindAndEqual)
+{
+  vl_thread_pool pool (4);
+  vl_vector<int> vec = iota_vector (big);
+  vec[big - 10] = 7;
+  EXPECT_EQ (vl_parallel_find (vec.begin (), vec.end (), 7, pool) - vec.begin (),
+             7);
+  EXPECT_EQ (vl_parallel_find (vec.begin (), vec.end (), -1, pool), vec.end ());
+  vl_vector<int> copy = vec;
+  EXPECT_TRUE (vl_parallel_equal (vec.begin (), vec.end (), copy.begin (),
+                                  pool));
+  copy[big / 2] = -1;
+  EXPECT_FALSE (vl_parallel_equal (vec.begin (), vec.end (), copy.begin (),
+                                   pool));
+}
+
+TEST (VlParallel, Sort)
+{
+  vl_thread_pool pool (4);
+  std::mt19937 gen (42);
+  vl_vector<unsigned> vec;
+  for (size_t i = 0; i < big; ++i)
+    vec.push_back (gen ());
+  vl_vector<unsigned> ref = vec;
+  std::sort (ref.begin (), ref.end ());
+  vl_parallel_sort (vec.begin (), vec.end (), std::less<> (), pool);
+  EXPECT_EQ (vec, ref);
+}
+
+TEST (VlParallel, SmallRangesRunOnTheCaller)
+{
+  vl_thread_pool pool (4);
+  vl_vector<int> vec = iota_vector (100);
+  std::thread::id caller = std::this_thread::get_id ();
+  std::atomic<int> elsewhere (0);
+  vl_parallel_for (vec.begin (), vec.end (), [&] (int &)
+  {
+    if (std::this_thread::get_id () != caller)
+      ++elsewhere;
+  }, pool);
+  EXPECT_EQ (elsewhere.load (), 0);
+}
+
+TEST (VlParallel, ExceptionsAndNesting)
+{
+  vl_thread_pool pool (4);
+  vl_vector<int> vec = iota_vector (big);
+  EXPECT_THROW (vl_parallel_for (vec.begin (), vec.end (), [] (int elem)
+  {
+    if (elem == 1000)
+      throw std::runtime_error ("bad elem");
+  }, pool), std::runtime_error);
+  // a chunk that runs a parallel call of its own
+  std::atomic<int64_t> total (0);
+  vl_vector<int> outer = iota_vector (8 * vl_parallel_min);
+  pool.run (8, 1, [&] (size_t from, size_t to)
+  {
+    for (size_t i = from; i < to; ++i)
+      total += vl_parallel_reduce (outer.begin (), outer.end (), int64_t (0),
+                                   std::plus<> (), pool);
+  });
+  int64_t n = static_cast<int64_t> (outer.size ());
+  EXPECT_EQ (total.load (), 8 * n * (n - 1) / 2);
+}
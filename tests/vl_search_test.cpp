@@ -0,0 +1,71 @@
+#include "vl_search.h"
+#include "vl_simd.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST (VlSearch, MatchesStdString)
+{
+  std::mt19937 rng (7);
+  for (int round = 0; round < 2000; ++round)
+    {
+      std::string hay (rng () % 200, 'a');
+      for (char &c : hay)
+        c = static_cast<char> ('a' + rng () % 3);
+      std::string needle (rng () % 40 + 1, 'a');
+      for (char &c : needle)
+        c = static_cast<char> ('a' + rng () % 3);
+      size_t from = rng () % (hay.size () + 2);
+      ASSERT_EQ (vl_find (hay.data (), hay.size (), needle.data (),
+                          needle.size (), from),
+                 hay.find (needle, from));
+      ASSERT_EQ (vl_rfind (hay.data (), hay.size (), needle.data (),
+                           needle.size (), from),
+                 hay.rfind (needle, from));
+      ASSERT_EQ (vl_find_first_of (hay.data (), hay.size (), "cx", 2, from),
+                 hay.find_first_of ("cx", from));
+      vl_string_searcher searcher (needle.data (), needle.size ());
+      ASSERT_EQ (searcher.find (hay.data (), hay.size (), from),
+                 hay.find (needle, from));
+    }
+}
+
+TEST (VlSearch, EmptyNeedle)
+{
+  EXPECT_EQ (vl_find ("abc", 3, "", 0, 2), 2u);
+  EXPECT_EQ (vl_find ("abc", 3, "", 0, 4), vl_npos);
+  EXPECT_EQ (vl_rfind ("abc", 3, "", 0), 3u);
+}
+
+template<typename T>
+class VlSimd : public ::testing::Test {};
+
+typedef ::testing::Types<int8_t, uint16_t, int32_t, uint64_t, float, double>
+    simd_types;
+TYPED_TEST_SUITE (VlSimd, simd_types);
+
+TYPED_TEST (VlSimd, FindAndCount)
+{
+  for (size_t n = 0; n < 100; ++n)
+    {
+      std::vector<TypeParam> arr (n);
+      for (size_t i = 0; i < n; ++i)
+        arr[i] = static_cast<TypeParam> (i % 7);
+      TypeParam value = static_cast<TypeParam> (5);
+      size_t expected = n > 5 ? 5 : n;
+      ASSERT_EQ (vl_simd_find (arr.data (), n, value), expected);
+      ASSERT_EQ (vl_simd_count (arr.data (), n, value),
+                 vl_scalar_count (arr.data (), n, value));
+    }
+}
+
+TEST (VlSimd, FloatZeroAndNan)
+{
+  std::vector<float> arr{1.0f, -0.0f, std::nanf ("")};
+  EXPECT_EQ (vl_simd_find (arr.data (), arr.size (), 0.0f), 1u);
+  EXPECT_EQ (vl_simd_find (arr.data (), arr.size (), std::nanf ("")), 3u);
+}
@@ -0,0 +1,199 @@
+#include "vl_serialize.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+/** a temp file, removed at the end of the test */
+struct temp_file {
+  char path[32] = "/tmp/vl_serialize_XXXXXX";
+
+  temp_file ()
+  { ::close (::mkstemp (path)); }
+  ~temp_file ()
+  { ::unlink (path); }
+};
+
+/** overwrites the uint64_t at offset of a file, to corrupt a record */
+void patch (const char *path, off_t offset, uint64_t value)
+{
+  int fd = ::open (path, O_WRONLY);
+  ASSERT_EQ (::pwrite (fd, &value, sizeof (value), offset),
+             ssize_t (sizeof (value)));
+  ::close (fd);
+}
+
+/** the offset of the count in a record header */
+constexpr off_t count_offset = 8;
+/** the offset of offset i in a strings record */
+constexpr off_t offset_at (int i)
+{ return sizeof (vl_blob_header) + i * sizeof (uint64_t); }
+
+struct point {
+  int32_t x;
+  int32_t y;
+  bool operator== (const point &other) const
+  { return x == other.x && y == other.y; }
+};
+
+}
+
+TEST (VlSerialize, WriteAndRead)
+{
+  temp_file file;
+  vl_vector<point, 4> points;
+  for (int i = 0; i < 100; ++i)
+    points.push_back (point {i, -i});
+  vl_vector<char, 4> bytes (size_t (3), 'z');
+  vl_string<> name ("dictionary");
+  vl_vector<vl_string<8>> words;
+  for (int i = 0; i < 1000; ++i) // more iovecs than IOV_MAX
+    words.emplace_back (std::string (i % 13, static_cast<char> ('a' + i % 26))
+                            .c_str ());
+  {
+    vl_blob_writer writer (file.path);
+    writer.write (points);
+    writer.write (bytes);
+    writer.write (name);
+    writer.write (words);
+    writer.write (vl_vector<double> ());
+  }
+  vl_vector<point, 4> points_in;
+  vl_vector<char, 4> bytes_in (size_t (10), 'x');
+  vl_string<4> name_in ("old");
+  vl_vector<vl_string<8>> words_in;
+  vl_vector<double> empty_in (size_t (2), 1.0);
+  vl_blob_reader reader (file.path);
+  reader.read (points_in);
+  reader.read (bytes_in);
+  reader.read (name_in);
+  reader.read (words_in);
+  reader.read (empty_in);
+  EXPECT_EQ (points_in, points);
+  EXPECT_EQ (bytes_in, bytes);
+  EXPECT_EQ (name_in.sv (), name.sv ());
+  ASSERT_EQ (words_in.size (), words.size ());
+  for (size_t i = 0; i < words.size (); ++i)
+    EXPECT_EQ (words_in[i].sv (), words[i].sv ());
+  EXPECT_TRUE (empty_in.empty ());
+  vl_vector<int> more;
+  EXPECT_THROW (reader.read (more), std::runtime_error);
+}
+
+TEST (VlSerialize, MappedViews)
+{
+  temp_file file;
+  vl_vector<uint64_t> ids;
+  for (uint64_t i = 0; i < 1000; ++i)
+    ids.push_back (i * i);
+  vl_vector<vl_string<>> words;
+  words.emplace_back ("alpha");
+  words.emplace_back ("");
+  words.emplace_back ("a much longer word than the static capacity");
+  {
+    vl_blob_writer writer (file.path);
+    writer.write (vl_string<> ("header"));
+    writer.write (ids);
+    writer.write (words);
+  }
+  vl_mapped_blobs mapped (file.path);
+  EXPECT_EQ (mapped.next_string (), "header");
+  vl_span<const uint64_t> ids_view = mapped.next_vector<uint64_t> ();
+  ASSERT_EQ (ids_view.size (), ids.size ());
+  EXPECT_EQ (reinterpret_cast<uintptr_t> (ids_view.data ()) % alignof (uint64_t),
+             0u);
+  EXPECT_EQ (ids_view[999], 999u * 999u);
+  vl_mapped_strings words_view = mapped.next_strings ();
+  ASSERT_EQ (words_view.size (), 3u);
+  EXPECT_EQ (words_view[0], "alpha");
+  EXPECT_EQ (words_view[1], "");
+  EXPECT_STREQ (words_view.c_str (2), words[2].c_str ());
+  EXPECT_TRUE (mapped.at_end ());
+  EXPECT_THROW (mapped.next_string (), std::runtime_error);
+}
+
+TEST (VlSerialize, WrongRecordThrows)
+{
+  temp_file file;
+  {
+    vl_blob_writer writer (file.path);
+    writer.write (vl_vector<int32_t> (size_t (3), 1));
+  }
+  vl_blob_reader reader (file.path);
+  vl_vector<int64_t> wrong;
+  EXPECT_THROW (reader.read (wrong), std::runtime_error);
+}
+
+TEST (VlSerialize, CorruptRecordThrows)
+{
+  vl_vector<vl_string<>> words;
+  words.emplace_back ("alpha");
+  words.emplace_back ("b");
+  // each case corrupts one uint64_t of a good record (offsets 0, 6, 8)
+  struct corruption {
+    int record; // 0 a string, 1 a vector, 2 strings
+    off_t offset;
+    uint64_t value;
+  };
+  const corruption cases[] = {
+      {0, count_offset, UINT64_MAX},
+      {0, count_offset, 1000},
+      {1, count_offset, (uint64_t (1) << 61) + 1}, // * 8 wraps to 8
+      {2, count_offset, UINT64_MAX},
+      {2, count_offset, (uint64_t (1) << 61) - 1}, // (+ 1) * 8 wraps to 0
+      {2, offset_at (0), 5},
+      {2, offset_at (1), 9},
+      {2, offset_at (2), 3},
+      {2, offset_at (2), UINT64_MAX},
+  };
+  for (const corruption &bad : cases)
+    {
+      temp_file file;
+      {
+        vl_blob_writer writer (file.path);
+        if (bad.record == 0)
+          writer.write (vl_string<> ("text"));
+        else if (bad.record == 1)
+          writer.write (vl_vector<uint64_t> (size_t (1), 7));
+        else
+          writer.write (words);
+      }
+      patch (file.path, bad.offset, bad.value);
+      vl_mapped_blobs mapped (file.path);
+      vl_blob_reader reader (file.path);
+      if (bad.record == 0)
+        {
+          vl_string<> str;
+          EXPECT_THROW (mapped.next_string (), std::runtime_error);
+          EXPECT_THROW (reader.read (str), std::runtime_error);
+        }
+      else if (bad.record == 1)
+        {
+          vl_vector<uint64_t> vec;
+          EXPECT_THROW (mapped.next_vector<uint64_t> (), std::runtime_error);
+          EXPECT_THROW (reader.read (vec), std::runtime_error);
+        }
+      else
+        {
+          vl_vector<vl_string<>> strs;
+          EXPECT_THROW (mapped.next_strings (), std::runtime_error);
+          EXPECT_THROW (reader.read (strs), std::runtime_error);
+        }
+    }
+
+  // offsets in order, but a string without its terminator
+  temp_file file;
+  {
+    vl_blob_writer writer (file.path);
+    writer.write (words);
+  }
+  patch (file.path, offset_at (1), 5);
+  vl_mapped_blobs mapped (file.path);
+  EXPECT_THROW (mapped.next_strings (), std::runtime_error);
+}
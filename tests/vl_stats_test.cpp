@@ -0,0 +1,112 @@
+#include "vl_vector.h"
+#include "vl_string.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+template<class Vector, size_t StaticCapacity, typename T>
+const vl_stats_site &site ()
+{ return vl_stats_site_of<Vector, StaticCapacity, sizeof (T)> (); }
+
+uint64_t events (const vl_stats_site &site, vl_stat_event event)
+{ return site.events[event].load (); }
+
+}
+
+TEST (VlStats, CountsSpillsAndReallocs)
+{
+  typedef vl_vector<int, 4, vl_shrink_eager> vector;
+  const vl_stats_site &counts = site<vector, 4, int> ();
+  {
+    vector vec;
+    for (int i = 0; i < 4; ++i)
+      vec.emplace_back (i);
+    EXPECT_EQ (events (counts, vl_stat_spill), 0u);
+    vec.push_back (4);
+    EXPECT_EQ (events (counts, vl_stat_spill), 1u);
+    uint64_t reallocs = events (counts, vl_stat_realloc);
+    while (vec.capacity () == vec.size () || vec.size () < 40)
+      vec.push_back (0);
+    EXPECT_GT (events (counts, vl_stat_realloc), reallocs);
+    vec.erase (vec.begin () + 2, vec.end ());
+    EXPECT_EQ (events (counts, vl_stat_to_static), 1u);
+    EXPECT_EQ (events (counts, vl_stat_copy), 0u);
+    vector copy (vec);
+    EXPECT_EQ (events (counts, vl_stat_copy), 2u);
+  }
+  EXPECT_EQ (counts.died (), 2u);
+  EXPECT_EQ (counts.sizes[2].load (), 2u);
+  EXPECT_EQ (counts.static_capacity, 4u);
+  EXPECT_EQ (counts.elem_size, sizeof (int));
+  EXPECT_NE (counts.name.find ("vl_vector<int, 4"), std::string::npos);
+}
+
+TEST (VlStats, CountsCopiesNotMoves)
+{
+  typedef vl_vector<std::string, 2> vector;
+  const vl_stats_site &counts = site<vector, 2, std::string> ();
+  vector vec;
+  std::string word ("word");
+  vec.push_back (word);
+  vec.push_back (std::string ("moved"));
+  vec.insert (vec.begin (), word);
+  std::string words[] = {"a", "b", "c"};
+  vec.insert (vec.end (), words, words + 3);
+  vec.insert (vec.end (), std::make_move_iterator (words),
+              std::make_move_iterator (words + 3));
+  vec.resize (10, word);
+  EXPECT_EQ (events (counts, vl_stat_copy), 1u + 1 + 3 + 1);
+  vector moved (std::move (vec));
+  EXPECT_EQ (events (counts, vl_stat_copy), 6u);
+}
+
+TEST (VlStats, SizeHistogram)
+{
+  EXPECT_EQ (vl_stats_bucket (0), 0u);
+  EXPECT_EQ (vl_stats_bucket (64), 64u);
+  EXPECT_EQ (vl_stats_bucket (65), vl_stats_bucket (127));
+  EXPECT_NE (vl_stats_bucket (127), vl_stats_bucket (128));
+  EXPECT_EQ (vl_stats_bucket_min (vl_stats_bucket (65)), 65u);
+  EXPECT_EQ (vl_stats_bucket_min (vl_stats_bucket (200)), 128u);
+  EXPECT_EQ (vl_stats_bucket (size_t (-1)), vl_stats_buckets - 1);
+
+  typedef vl_vector<char, 8> vector;
+  const vl_stats_site &counts = site<vector, 8, char> ();
+  for (size_t size = 1; size <= 100; ++size)
+    vector vec (size, 'x');
+  EXPECT_EQ (counts.died (), 100u);
+  EXPECT_EQ (counts.percentile (0.5), 50u);
+  EXPECT_EQ (counts.percentile (0.08), 8u);
+  EXPECT_EQ (counts.percentile (1), 65u);
+  EXPECT_DOUBLE_EQ (counts.fit (8), 0.08);
+}
+
+TEST (VlStats, Report)
+{
+  typedef vl_vector<int, 4, vl_shrink_eager> vector;
+  { vector vec (size_t (3), 1); }
+  std::ostringstream text;
+  vl_stats_report (text);
+  EXPECT_NE (text.str ().find ("vl_vector<int, 4"), std::string::npos);
+  EXPECT_NE (text.str ().find ("% fit in the static array"), std::string::npos);
+  std::ostringstream json;
+  vl_stats_report (json, true);
+  EXPECT_EQ (json.str ().front (), '[');
+  EXPECT_NE (json.str ().find ("\"static_capacity\": 4"), std::string::npos);
+  EXPECT_NE (json.str ().find ("\"spill\": "), std::string::npos);
+}
+
+TEST (VlStats, Strings)
+{
+  {
+    vl_string<4> str ("ab");
+    str += "cdefghijklmnopqrstuvwxyz";
+  }
+  const vl_stats_site &counts = site<vl_string<4>, 23, char> ();
+  EXPECT_EQ (events (counts, vl_stat_spill), 1u);
+  EXPECT_EQ (counts.died (), 1u);
+}
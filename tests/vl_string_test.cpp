@@ -0,0 +1,283 @@
+#include "vl_string.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+template<class String>
+std::string str (const String &vl_str)
+{ return std::string (vl_str.data (), vl_str.size ()); }
+
+}
+
+TEST (VlString, ConstructAndAppend)
+{
+  vl_string<> empty;
+  EXPECT_EQ (empty.size (), 0u);
+  EXPECT_TRUE (empty.empty ());
+  EXPECT_STREQ (empty.c_str (), "");
+  vl_string<4> text ("abc");
+  text += "defgh";
+  text += 'i';
+  text += vl_string<4> ("jk");
+  EXPECT_EQ (str (text), "abcdefghijk");
+  EXPECT_STREQ (static_cast<const char *> (text), "abcdefghijk");
+  text.pop_back ();
+  EXPECT_EQ (str (text), "abcdefghij");
+  EXPECT_FALSE (text.empty ());
+  text.clear ();
+  EXPECT_STREQ (text.c_str (), "");
+  EXPECT_TRUE (text.empty ());
+}
+
+TEST (VlString, AppendFromItself)
+{
+  vl_string<4> text ("0123456789");
+  std::string ref ("0123456789");
+  for (int i = 0; i < 8; ++i)
+    {
+      text.append (text.data () + 3, text.size () - 3);
+      ref.append (ref.data () + 3, ref.size () - 3);
+    }
+  EXPECT_EQ (str (text), ref);
+}
+
+TEST (VlString, Concatenation)
+{
+  vl_string<> a ("hello");
+  vl_string<> b ("world");
+  vl_string<> joined = a + ", " + b + '!';
+  EXPECT_EQ (str (joined), "hello, world!");
+  vl_string<> wrapped = '<' + ("[" + a + "]") + '>';
+  EXPECT_EQ (str (wrapped), "<[hello]>");
+  EXPECT_TRUE (joined == a + ", " + b + '!');
+  EXPECT_TRUE (a + b != joined);
+  // every piece may come from the string it is appended to
+  vl_string<> twice ("ab");
+  for (int i = 0; i < 6; ++i)
+    twice += twice + '-' + twice;
+  EXPECT_EQ (twice.size (), 2u * 729 + 364);
+}
+
+TEST (VlString, Builder)
+{
+  vl_string_builder<> builder;
+  builder.reserve (64).append ("id=").append_format ("%d", 42).append (' ');
+  builder.append (vl_string<> ("name=")).append ("x" + vl_string<> ("y"));
+  for (int i = 0; i < 20; ++i)
+    builder.append_format (";%s%03d", "field", i);
+  std::string ref = "id=42 name=xy";
+  for (int i = 0; i < 20; ++i)
+    ref += ";field" + std::string (i < 10 ? "00" : "0") + std::to_string (i);
+  EXPECT_EQ (builder.size (), ref.size ());
+  vl_string<> built = builder.build ();
+  EXPECT_EQ (str (built), ref);
+  EXPECT_EQ (builder.size (), 0u);
+}
+
+TEST (VlString, Search)
+{
+  vl_string<> text ("the quick brown fox jumps over the lazy dog");
+  EXPECT_TRUE (text.contains ("fox"));
+  EXPECT_FALSE (text.contains ("cat"));
+  EXPECT_TRUE (text.contains ('z'));
+  EXPECT_EQ (text.find ("the"), 0u);
+  EXPECT_EQ (text.find ("the", 1), 31u);
+  EXPECT_EQ (text.rfind ("the"), 31u);
+  EXPECT_EQ (text.rfind ('o'), 41u);
+  EXPECT_EQ (text.find_first_of ("xyz"), 18u);
+  EXPECT_EQ (text.find ("dogs"), vl_string<>::npos);
+  vl_string_searcher searcher ("over the lazy dog, and back again!");
+  EXPECT_FALSE (text.contains (searcher));
+  vl_string_searcher short_searcher ("jumps");
+  EXPECT_EQ (text.find (short_searcher), 20u);
+}
+
+TEST (VlString, ResizeAndAssign)
+{
+  vl_string<4> text ("ab");
+  text.resize (5, '-');
+  EXPECT_STREQ (text.c_str (), "ab---");
+  text.resize (1);
+  EXPECT_STREQ (text.c_str (), "a");
+  char *dest = text.append_uninitialized (3);
+  std::memcpy (dest, "xyz", 3);
+  EXPECT_EQ (str (text), "axyz");
+  std::string src ("assigned");
+  text.assign (src.begin (), src.end ());
+  EXPECT_EQ (str (text), src);
+  EXPECT_EQ (text.size (), src.size ());
+
+  // growing a little at a time reallocates geometrically, not every time
+  vl_string<> grown;
+  size_t reallocs = 0;
+  for (size_t len = 1; len <= 4096; ++len)
+    {
+      size_t cap = grown.capacity ();
+      if (len % 2 == 0)
+        grown.resize (len, 'x');
+      else
+        grown.resize_for_overwrite (len);
+      reallocs += grown.capacity () != cap;
+    }
+  EXPECT_LT (reallocs, 32u);
+  grown.reserve (5000);
+  EXPECT_EQ (grown.capacity (), 5000u);
+}
+
+TEST (VlString, Views)
+{
+  std::string_view src ("key=value; other=thing");
+  vl_string<4> text (src.substr (0, 9));
+  EXPECT_EQ (str (text), "key=value");
+  EXPECT_EQ (text.sv (), "key=value");
+  std::string_view value = text.substr (4);
+  EXPECT_EQ (value, "value");
+  EXPECT_EQ (value.data (), text.data () + 4);
+  EXPECT_EQ (text.substr (0, 3), "key");
+  EXPECT_THROW (text.substr (10), std::out_of_range);
+  text += src.substr (9);
+  EXPECT_EQ (text.sv (), src);
+  EXPECT_TRUE (text.contains (std::string_view ("other")));
+  vl_string<> joined = text + std::string_view ("!");
+  EXPECT_EQ (joined.sv ().back (), '!');
+}
+
+TEST (VlString, Split)
+{
+  vl_string<> line ("a,bb,,ccc");
+  std::vector<std::string_view> fields;
+  for (std::string_view field : line.split (','))
+    fields.push_back (field);
+  EXPECT_EQ (fields, (std::vector<std::string_view>{"a", "bb", "", "ccc"}));
+  EXPECT_EQ (fields[1].data (), line.data () + 2);
+  fields.clear ();
+  for (std::string_view field : vl_split ("x::y::", "::"))
+    fields.push_back (field);
+  EXPECT_EQ (fields, (std::vector<std::string_view>{"x", "y", ""}));
+  fields.assign (vl_split ("", ',').begin (), vl_split ("", ',').end ());
+  EXPECT_EQ (fields, (std::vector<std::string_view>{""}));
+}
+
+TEST (VlString, InlineChars)
+{
+  EXPECT_EQ (sizeof (vl_string<>), 24u);
+  EXPECT_EQ (vl_string<>::inline_capacity, 23u);
+  EXPECT_EQ (vl_string<4>::inline_capacity, 23u);
+  EXPECT_EQ (sizeof (vl_string<32>), 40u);
+  EXPECT_EQ (vl_string<32>::inline_capacity, 39u);
+  EXPECT_TRUE (vl_is_trivially_relocatable<vl_string<>>::value);
+
+  vl_string<> text;
+  const char *object = reinterpret_cast<const char *> (&text);
+  std::string ref;
+  for (char c = 'a'; ref.size () < 23; ++c)
+    {
+      text.push_back (c);
+      ref.push_back (c);
+    }
+  EXPECT_EQ (text.data (), object);
+  EXPECT_EQ (text.capacity (), 23u);
+  EXPECT_STREQ (text.c_str (), ref.c_str ());
+  EXPECT_EQ (str (text), ref);
+  text.push_back ('!');
+  ref.push_back ('!');
+  EXPECT_NE (text.data (), object);
+  EXPECT_GT (text.capacity (), 23u);
+  EXPECT_STREQ (text.c_str (), ref.c_str ());
+  text.resize (23);
+  text.shrink_to_fit ();
+  EXPECT_EQ (text.data (), object);
+  EXPECT_EQ (text.size (), 23u);
+  EXPECT_EQ (str (text), ref.substr (0, 23));
+}
+
+TEST (VlString, LazyTerminator)
+{
+  vl_string<> text ("abcdef");
+  text.pop_back ();
+  text.pop_back ();
+  EXPECT_EQ (text.size (), 4u);
+  EXPECT_STREQ (text.c_str (), "abcd");
+  EXPECT_STREQ (static_cast<const char *> (text), "abcd");
+  const vl_string<> full ("0123456789abcdefghijklm");
+  EXPECT_EQ (full.size (), 23u);
+  EXPECT_STREQ (full.c_str (), "0123456789abcdefghijklm");
+  EXPECT_EQ (full.size (), 23u);
+}
+
+TEST (VlString, InsertErase)
+{
+  vl_string<> text ("held");
+  text.insert (text.begin () + 2, 'l');
+  text.insert (text.begin (), 'a');
+  EXPECT_EQ (str (text), "ahelld");
+  std::string more (" world, and more than the inline chars");
+  text.insert (text.end (), more.begin (), more.end ());
+  EXPECT_EQ (str (text), "ahelld" + more);
+  text.erase (text.begin ());
+  text.erase (text.begin () + 5, text.begin () + 11);
+  EXPECT_EQ (str (text), "helld, and more than the inline chars");
+  // a range of the string itself
+  text.insert (text.begin (), text.begin () + 7, text.begin () + 15);
+  EXPECT_EQ (str (text).substr (0, 8), "and more");
+  EXPECT_EQ (text.at (0), 'a');
+  EXPECT_THROW (text.at (text.size ()), std::out_of_range);
+}
+
+TEST (VlString, CopyMoveSwap)
+{
+  vl_string<> small ("small");
+  vl_string<> big ("a string that does not fit in the object");
+  vl_string<> copy (big);
+  EXPECT_TRUE (copy == big);
+  EXPECT_NE (copy.data (), big.data ());
+  copy = small;
+  EXPECT_TRUE (copy == "small");
+  EXPECT_TRUE ("small" == copy);
+  EXPECT_TRUE (copy != big);
+  vl_string<> moved (std::move (big));
+  EXPECT_TRUE (big.empty ());
+  EXPECT_EQ (moved.sv (), "a string that does not fit in the object");
+  swap (moved, small);
+  EXPECT_TRUE (moved == "small");
+  EXPECT_EQ (small.size (), 40u);
+  small = std::move (moved);
+  EXPECT_TRUE (small == "small");
+  EXPECT_TRUE (moved.empty ());
+
+  vl_vector<vl_string<>, 2> strings;
+  for (int i = 0; i < 10; ++i)
+    strings.push_back (vl_string<> (std::string (i * 5, 'x')));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ (strings[i].sv (), std::string (i * 5, 'x'));
+}
+
+TEST (VlString, LongInlineCapacity)
+{
+  typedef vl_string<200> long_string;
+  EXPECT_EQ (long_string::inline_capacity, 200u);
+  EXPECT_EQ (sizeof (long_string), 208u);
+  long_string text;
+  std::string ref;
+  for (int i = 0; i < 300; ++i)
+    {
+      text.push_back (static_cast<char> ('a' + i % 26));
+      ref.push_back (static_cast<char> ('a' + i % 26));
+      if (i == 199)
+        {
+          EXPECT_EQ (text.data (), reinterpret_cast<char *> (&text));
+          EXPECT_STREQ (text.c_str (), ref.c_str ());
+        }
+    }
+  EXPECT_STREQ (text.c_str (), ref.c_str ());
+  text.resize (10);
+  text.shrink_to_fit ();
+  EXPECT_EQ (text.data (), reinterpret_cast<char *> (&text));
+  EXPECT_EQ (str (text), ref.substr (0, 10));
+}
@@ -0,0 +1,81 @@
+#include "vl_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** the trace of the site named name, or an empty one */
+vl_trace_site site_named (const std::string &name)
+{
+  for (const vl_trace_site &site : vl_trace_recorder::instance ().sites ())
+    if (site.name.find (name) == 0)
+      return site;
+  return vl_trace_site ();
+}
+
+/** the ops of a trace as text, one "op object pos count" group per record */
+std::string ops_of (const vl_trace_site &site)
+{
+  std::ostringstream ops;
+  for (const vl_trace_record &record : site.records)
+    ops << char (record.op) << record.object << ":" << record.pos << ","
+        << record.count << " ";
+  return ops.str ();
+}
+
+}
+
+TEST (VlTrace, RecordsOps)
+{
+  {
+    vl_vector<short, 3> vec;
+    vec.push_back (1);
+    vec.push_back (2);
+    short more[] = {3, 4, 5};
+    vec.insert (vec.begin () + 1, more, more + 3);
+    vec.erase (vec.begin (), vec.begin () + 2);
+    vec.pop_back ();
+    vec.resize (6);
+    vec.reserve (20);
+    vl_vector<short, 3> copy (vec);
+    copy.push_back (7);
+    vl_vector<short, 3> moved (std::move (copy));
+  }
+  vl_trace_site site = site_named ("vl_vector<short, 3");
+  EXPECT_EQ (site.static_capacity, 3u);
+  EXPECT_EQ (site.elem_size, sizeof (short));
+  EXPECT_EQ (ops_of (site),
+             "n0:0,0 p0:0,0 p0:0,0 i0:1,3 e0:0,2 o0:0,0 r0:0,6 v0:0,20 "
+             "n1:0,6 p1:0,0 n2:0,0 t2:1,0 d2:0,0 d1:0,0 d0:0,0 ");
+}
+
+TEST (VlTrace, WriteAndRead)
+{
+  std::vector<vl_trace_site> sites (2);
+  sites[0] = {"vl_vector<int, 16ul>", 16, 4,
+              {{0, vl_trace_new, 0, 0}, {0, vl_trace_insert, 0, 40},
+               {0, vl_trace_destroy, 0, 0}}};
+  sites[1] = {"vl_vector<char, 8ul>", 8, 1,
+              {{3, vl_trace_swap, 5, 0}}};
+  std::stringstream text;
+  vl_trace_write (text, sites);
+  std::vector<vl_trace_site> read = vl_trace_read (text);
+  ASSERT_EQ (read.size (), 2u);
+  EXPECT_EQ (read[0].name, sites[0].name);
+  EXPECT_EQ (read[0].static_capacity, 16u);
+  EXPECT_EQ (read[1].elem_size, 1u);
+  EXPECT_EQ (ops_of (read[0]), ops_of (sites[0]));
+  EXPECT_EQ (ops_of (read[1]), "s3:5,0 ");
+
+  std::istringstream not_trace ("hello\n");
+  EXPECT_THROW (vl_trace_read (not_trace), std::runtime_error);
+  std::istringstream bad_op (std::string (vl_trace_magic)
+                             + "\nsite 0 4 4 x\n0 0 z 0 0\n");
+  EXPECT_THROW (vl_trace_read (bad_op), std::runtime_error);
+  std::istringstream bad_site (std::string (vl_trace_magic) + "\n1 0 p 0 0\n");
+  EXPECT_THROW (vl_trace_read (bad_site), std::runtime_error);
+}
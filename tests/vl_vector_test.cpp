@@ -0,0 +1,506 @@
+#include "vl_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/** counts the live objects, to catch leaks and double destruction */
+struct tracked {
+  static int alive;
+  int value;
+
+  tracked (int v = 0) : value (v)
+  { ++alive; }
+  tracked (const tracked &other) : value (other.value)
+  { ++alive; }
+  tracked &operator= (const tracked &) = default;
+  ~tracked ()
+  { --alive; }
+  bool operator== (const tracked &other) const
+  { return value == other.value; }
+};
+int tracked::alive = 0;
+
+/**
+ * counts its live objects and copies. a copy throws once copies_left runs
+ * out, and the move ctor may throw unless NothrowMove
+ */
+template<bool NothrowMove>
+struct counted {
+  static int alive;
+  static int copies;
+  static int copies_left;
+  int value;
+
+  counted (int v = 0) : value (v)
+  { ++alive; }
+  counted (const counted &other) : value (other.value)
+  {
+    copy ();
+    ++alive;
+  }
+  counted (counted &&other) noexcept (NothrowMove) : value (other.value)
+  { ++alive; }
+  counted &operator= (const counted &other)
+  {
+    copy ();
+    value = other.value;
+    return *this;
+  }
+  counted &operator= (counted &&other) = default;
+  ~counted ()
+  { --alive; }
+  operator int () const
+  { return value; }
+
+  static void copy ()
+  {
+    if (copies_left == 0)
+      throw std::runtime_error ("copy failed");
+    --copies_left;
+    ++copies;
+  }
+};
+template<bool NothrowMove> int counted<NothrowMove>::alive = 0;
+template<bool NothrowMove> int counted<NothrowMove>::copies = 0;
+template<bool NothrowMove> int counted<NothrowMove>::copies_left = -1;
+
+template<class Vector>
+std::vector<int> values (const Vector &vec)
+{
+  std::vector<int> ret;
+  for (const auto &elem : vec)
+    ret.push_back (static_cast<int> (elem));
+  return ret;
+}
+
+/**
+ * a stateful allocator, allocators of different ids can't free each other's
+ * arrays. they go along on swap, but not on move assignment
+ */
+template<typename T>
+struct tagged_allocator {
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_swap;
+  typedef std::false_type propagate_on_container_move_assignment;
+  typedef std::false_type is_always_equal;
+  int id;
+
+  explicit tagged_allocator (int tag = 0) : id (tag)
+  {}
+  template<typename U>
+  tagged_allocator (const tagged_allocator<U> &other) : id (other.id)
+  {}
+  T *allocate (size_t n)
+  {
+    // the id is kept before the array, to check who frees it
+    int *block = static_cast<int *> (
+        ::operator new (n * sizeof (T) + alignof (std::max_align_t)));
+    *block = id;
+    return reinterpret_cast<T *> (reinterpret_cast<char *> (block)
+                                  + alignof (std::max_align_t));
+  }
+  void deallocate (T *arr, size_t)
+  {
+    int *block = reinterpret_cast<int *> (reinterpret_cast<char *> (arr)
+                                          - alignof (std::max_align_t));
+    EXPECT_EQ (*block, id);
+    ::operator delete (block);
+  }
+  bool operator== (const tagged_allocator &other) const
+  { return id == other.id; }
+  bool operator!= (const tagged_allocator &other) const
+  { return id != other.id; }
+};
+
+}
+
+TEST (VlVector, PushBackSpillsToHeapAndBack)
+{
+  vl_vector<int, 4> vec;
+  EXPECT_EQ (vec.capacity (), 4u);
+  for (int i = 0; i < 4; ++i)
+    vec.push_back (i);
+  EXPECT_EQ (vec.capacity (), 4u);
+  vec.push_back (4);
+  EXPECT_GT (vec.capacity (), 4u);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 1, 2, 3, 4}));
+  while (vec.size () > 1)
+    vec.pop_back ();
+  EXPECT_EQ (vec.capacity (), 4u);
+  EXPECT_EQ (vec[0], 0);
+}
+
+TEST (VlVector, Constructors)
+{
+  vl_vector<int, 4> filled (size_t (6), 7);
+  EXPECT_EQ (values (filled), std::vector<int> (6, 7));
+  std::vector<int> src{1, 2, 3, 4, 5};
+  vl_vector<int, 4> range (src.begin (), src.end ());
+  EXPECT_EQ (values (range), src);
+  vl_vector<int, 4> copy (range);
+  EXPECT_EQ (copy, range);
+  vl_vector<int, 4> moved (std::move (copy));
+  EXPECT_EQ (moved, range);
+  EXPECT_TRUE (copy.empty ());
+}
+
+TEST (VlVector, InsertAndErase)
+{
+  vl_vector<int, 4> vec;
+  for (int i = 0; i < 6; ++i)
+    vec.push_back (i);
+  vec.insert (vec.begin () + 2, 42);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 1, 42, 2, 3, 4, 5}));
+  std::vector<int> more{7, 8, 9};
+  vec.insert (vec.begin (), more.begin (), more.end ());
+  EXPECT_EQ (values (vec), (std::vector<int>{7, 8, 9, 0, 1, 42, 2, 3, 4, 5}));
+  auto it = vec.erase (vec.begin () + 1, vec.begin () + 4);
+  EXPECT_EQ (*it, 1);
+  it = vec.erase (vec.begin ());
+  EXPECT_EQ (*it, 1);
+  EXPECT_EQ (values (vec), (std::vector<int>{1, 42, 2, 3, 4, 5}));
+  EXPECT_THROW (vec.at (6), std::out_of_range);
+}
+
+TEST (VlVector, NonTrivialElemsAreDestroyed)
+{
+  {
+    vl_vector<tracked, 2> vec;
+    for (int i = 0; i < 10; ++i)
+      vec.push_back (tracked (i));
+    vec.insert (vec.begin () + 3, tracked (-1));
+    vec.erase (vec.begin (), vec.begin () + 5);
+    vl_vector<tracked, 2> copy = vec;
+    copy.clear ();
+    EXPECT_EQ (tracked::alive, static_cast<int> (vec.size ()));
+  }
+  EXPECT_EQ (tracked::alive, 0);
+}
+
+TEST (VlVector, StringElems)
+{
+  vl_vector<std::string, 2> vec;
+  for (int i = 0; i < 5; ++i)
+    vec.emplace_back (40, static_cast<char> ('a' + i));
+  vec.emplace (vec.begin (), "front");
+  EXPECT_EQ (vec[0], "front");
+  EXPECT_EQ (vec[5], std::string (40, 'e'));
+}
+
+TEST (VlVector, SearchFunctions)
+{
+  vl_vector<int, 8> vec;
+  for (int i = 0; i < 100; ++i)
+    vec.push_back (i % 10);
+  EXPECT_TRUE (vec.contains (9));
+  EXPECT_FALSE (vec.contains (10));
+  EXPECT_EQ (vec.find (3) - vec.begin (), 3);
+  EXPECT_EQ (vec.find (10), vec.end ());
+  EXPECT_EQ (vec.count (7), 10u);
+  EXPECT_EQ (vec.count_if ([] (int v) { return v < 5; }), 50u);
+}
+
+TEST (VlVector, EqualityComparesStaticAndHeap)
+{
+  vl_vector<int, 4> small;
+  vl_vector<int, 4> big;
+  for (int i = 0; i < 3; ++i)
+    {
+      small.push_back (i);
+      big.push_back (i);
+    }
+  for (int i = 0; i < 10; ++i)
+    big.push_back (i);
+  for (int i = 0; i < 10; ++i)
+    big.pop_back ();
+  EXPECT_EQ (small, big);
+  big.push_back (5);
+  EXPECT_NE (small, big);
+}
+
+TEST (VlVector, ShrinkPolicies)
+{
+  vl_vector<int, 4, vl_shrink_never> never;
+  vl_vector<int, 4, vl_shrink_explicit> explicit_vec;
+  for (int i = 0; i < 100; ++i)
+    {
+      never.push_back (i);
+      explicit_vec.push_back (i);
+    }
+  size_t cap = never.capacity ();
+  never.erase (never.begin () + 2, never.end ());
+  explicit_vec.erase (explicit_vec.begin () + 2, explicit_vec.end ());
+  EXPECT_EQ (never.capacity (), cap);
+  EXPECT_GT (explicit_vec.capacity (), 4u);
+  explicit_vec.shrink_to_fit ();
+  EXPECT_EQ (explicit_vec.capacity (), 4u);
+  EXPECT_EQ (values (explicit_vec), (std::vector<int>{0, 1}));
+}
+
+TEST (VlVector, GrowthPolicies)
+{
+  vl_vector<int, 4, vl_shrink_hysteresis<>, vl_growth_pow2> pow2;
+  vl_vector<int, 4, vl_shrink_hysteresis<>, vl_growth_exact> exact;
+  for (int i = 0; i < 5; ++i)
+    {
+      pow2.push_back (i);
+      exact.push_back (i);
+    }
+  EXPECT_EQ (pow2.capacity (), 8u);
+  EXPECT_EQ (exact.capacity (), 5u);
+  exact.reserve (100);
+  EXPECT_EQ (exact.capacity (), 100u);
+}
+
+TEST (VlVector, Swap)
+{
+  vl_vector<int, 4> lhs (size_t (2), 1);
+  vl_vector<int, 4> rhs (size_t (10), 2);
+  swap (lhs, rhs);
+  EXPECT_EQ (values (lhs), std::vector<int> (10, 2));
+  EXPECT_EQ (values (rhs), std::vector<int> (2, 1));
+}
+
+TEST (VlVector, SwapWithAllocators)
+{
+  typedef vl_vector<std::string, 2, vl_shrink_never,
+                    vl_growth_1_5x, tagged_allocator<std::string>> vector;
+  static_assert (noexcept (std::declval<vector &> ().swap (
+      std::declval<vector &> ())));
+  vector heap_vec ((tagged_allocator<std::string> (1)));
+  vector static_vec ((tagged_allocator<std::string> (2)));
+  for (int i = 0; i < 5; ++i)
+    heap_vec.push_back (std::string (30, static_cast<char> ('a' + i)));
+  static_vec.push_back ("x");
+
+  // heap and static - the allocator goes with the heap array
+  heap_vec.swap (static_vec);
+  EXPECT_EQ (heap_vec.get_allocator ().id, 2);
+  EXPECT_EQ (static_vec.get_allocator ().id, 1);
+  ASSERT_EQ (heap_vec.size (), 1u);
+  EXPECT_EQ (heap_vec[0], "x");
+  ASSERT_EQ (static_vec.size (), 5u);
+  EXPECT_EQ (static_vec[4], std::string (30, 'e'));
+  static_vec.swap (heap_vec);
+  EXPECT_EQ (static_vec[0], "x");
+  EXPECT_EQ (heap_vec.get_allocator ().id, 1);
+
+  // both static, of different sizes
+  vector one ((tagged_allocator<std::string> (3)));
+  vector two ((tagged_allocator<std::string> (4)));
+  one.push_back ("1");
+  two.push_back ("2");
+  two.push_back ("22");
+  one.swap (two);
+  EXPECT_EQ (one.size (), 2u);
+  EXPECT_EQ (one[1], "22");
+  EXPECT_EQ (two.size (), 1u);
+  EXPECT_EQ (one[0], "2");
+  EXPECT_EQ (two[0], "1");
+  EXPECT_EQ (one.get_allocator ().id, 4);
+  // both on the heap, freed by their own allocators at the end
+  one.swap (heap_vec);
+  two.swap (static_vec);
+}
+
+TEST (VlVector, CompactLayout)
+{
+  // no vtable, and the heap capacity shares its bytes with the static array
+  EXPECT_FALSE ((std::is_polymorphic<vl_vector<char, 16>>::value));
+  EXPECT_LE (sizeof (vl_vector<char, 16>), 16 + 2 * sizeof (void *));
+  vl_vector<long, 2, vl_shrink_eager> vec;
+  for (long i = 0; i < 10; ++i)
+    vec.push_back (i);
+  EXPECT_GE (vec.capacity (), 10u);
+  while (vec.size () > 2)
+    vec.pop_back ();
+  EXPECT_EQ (vec.capacity (), 2u);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 1}));
+}
+
+TEST (VlVector, Resize)
+{
+  vl_vector<int, 4> vec;
+  vec.resize (3);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 0, 0}));
+  vec.resize (6, 7);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 0, 0, 7, 7, 7}));
+  // the fill value may be an elem that moves when the vector grows
+  vec.resize (40, vec[5]);
+  EXPECT_EQ (vec.size (), 40u);
+  EXPECT_EQ (vec.count (7), 37u);
+  vec.resize (2);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 0}));
+  vl_vector<tracked, 2> objs;
+  objs.resize (5, tracked (3));
+  objs.resize (1);
+  EXPECT_EQ (tracked::alive, 1);
+}
+
+TEST (VlVector, AppendUninitialized)
+{
+  vl_vector<char, 8> buf;
+  buf.push_back ('>');
+  char *dest = buf.append_uninitialized (20);
+  EXPECT_EQ (dest, buf.data () + 1);
+  EXPECT_EQ (buf.size (), 21u);
+  std::memset (dest, 'x', 20);
+  EXPECT_EQ (buf.count ('x'), 20u);
+  buf.resize_for_overwrite (4);
+  EXPECT_EQ (buf.size (), 4u);
+  EXPECT_EQ (buf[0], '>');
+}
+
+TEST (VlVector, AssignAndAppend)
+{
+  std::vector<int> src{1, 2, 3, 4, 5, 6};
+  vl_vector<int, 4> vec (size_t (2), 9);
+  vec.append (src.begin (), src.end ());
+  EXPECT_EQ (values (vec), (std::vector<int>{9, 9, 1, 2, 3, 4, 5, 6}));
+  vec.assign (src.begin (), src.begin () + 3);
+  EXPECT_EQ (values (vec), (std::vector<int>{1, 2, 3}));
+}
+
+TEST (VlVector, InsertInputIterators)
+{
+  std::istringstream input ("1 2 3 4 5 6");
+  vl_vector<int, 4> vec (size_t (2), 0);
+  auto it = vec.insert (vec.begin () + 1, std::istream_iterator<int> (input),
+                        std::istream_iterator<int> ());
+  EXPECT_EQ (*it, 1);
+  EXPECT_EQ (values (vec), (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 0}));
+  std::istringstream more ("7 8");
+  vl_vector<int, 4> built ((std::istream_iterator<int> (more)),
+                           std::istream_iterator<int> ());
+  EXPECT_EQ (values (built), (std::vector<int>{7, 8}));
+}
+
+TEST (VlVector, Span)
+{
+  vl_vector<int, 4> vec;
+  for (int i = 0; i < 10; ++i)
+    vec.push_back (i);
+  vl_span<int> all = vec.as_span ();
+  EXPECT_EQ (all.data (), vec.data ());
+  EXPECT_EQ (all.size (), 10u);
+  vl_span<int> mid = all.subspan (3, 4);
+  EXPECT_EQ (values (mid), (std::vector<int>{3, 4, 5, 6}));
+  mid[0] = 42;
+  EXPECT_EQ (vec[3], 42);
+  vl_span<const int> tail = all.last (2);
+  EXPECT_EQ (values (tail), (std::vector<int>{8, 9}));
+  EXPECT_EQ (all.subspan (8).size (), 2u);
+  EXPECT_THROW (all.subspan (11), std::out_of_range);
+}
+
+TEST (VlVector, GrowthMovesIfNoexcept)
+{
+  vl_vector<counted<true>, 2> movable;
+  vl_vector<counted<false>, 2> copied;
+  for (int i = 0; i < 20; ++i)
+    {
+      movable.emplace_back (i);
+      copied.emplace_back (i);
+    }
+  // a move that may throw can't give the strong guarantee, so growth copies
+  EXPECT_EQ (counted<true>::copies, 0);
+  EXPECT_GT (counted<false>::copies, 0);
+  EXPECT_EQ (values (movable), values (copied));
+}
+
+TEST (VlVector, StrongGuaranteeOnGrowth)
+{
+  typedef counted<false> elem;
+  for (int first_size : {4, 10})
+    { // a full static array, then a full heap array
+      vl_vector<elem, 4> vec;
+      for (int i = 0; i < first_size; ++i)
+        vec.emplace_back (i);
+      while (vec.size () < vec.capacity ())
+        vec.emplace_back (static_cast<int> (vec.size ()));
+      std::vector<int> before = values (vec);
+      const elem *arr = vec.data ();
+      size_t cap = vec.capacity ();
+      std::vector<elem> more{elem (-1), elem (-2)};
+
+      // the moves to the new array copy, and the second copy throws
+      elem::copies_left = 1;
+      EXPECT_THROW (vec.emplace_back (99), std::runtime_error);
+      elem::copies_left = 1;
+      EXPECT_THROW (vec.insert (vec.begin () + 1, elem (98)),
+                    std::runtime_error);
+      elem::copies_left = 3; // the range itself, then one of the elems
+      EXPECT_THROW (vec.insert (vec.begin () + 2, more.begin (), more.end ()),
+                    std::runtime_error);
+      elem::copies_left = 1;
+      EXPECT_THROW (vec.reserve (100), std::runtime_error);
+      elem::copies_left = -1;
+
+      EXPECT_EQ (values (vec), before);
+      EXPECT_EQ (vec.data (), arr);
+      EXPECT_EQ (vec.capacity (), cap);
+      EXPECT_EQ (elem::alive, static_cast<int> (vec.size () + more.size ()));
+    }
+}
+
+TEST (VlVector, CopyAssign)
+{
+  vl_vector<int, 2> big (size_t (10), 1);
+  vl_vector<int, 2> small (size_t (6), 2);
+  const int *arr = big.data ();
+  big = small; // the elems fit, so the heap array is reused
+  EXPECT_EQ (big.data (), arr);
+  EXPECT_EQ (values (big), values (small));
+
+  typedef counted<false> elem;
+  vl_vector<elem, 2> target;
+  vl_vector<elem, 2> source;
+  for (int i = 0; i < 5; ++i)
+    {
+      target.emplace_back (i);
+      source.emplace_back (-i);
+    }
+  std::vector<int> before = values (target);
+  elem::copies_left = 3;
+  EXPECT_THROW (target = source, std::runtime_error);
+  elem::copies_left = -1;
+  EXPECT_EQ (values (target), before);
+  target = source;
+  EXPECT_EQ (values (target), values (source));
+  EXPECT_EQ (elem::alive, 10);
+}
+
+TEST (VlVector, CopySizedForElems)
+{
+  // a heap vector that doesn't give its memory back
+  vl_vector<int, 4, vl_shrink_never> vec;
+  for (int i = 0; i < 100; ++i)
+    vec.push_back (i);
+  vec.resize (3);
+  ASSERT_GT (vec.capacity (), 4u);
+  vl_vector<int, 4, vl_shrink_never> copy (vec);
+  EXPECT_EQ (copy.capacity (), 4u); // back in the static array
+  EXPECT_EQ (values (copy), values (vec));
+
+  vec.resize (20);
+  vl_vector<int, 4, vl_shrink_never> heap_copy (vec);
+  EXPECT_GE (heap_copy.capacity (), 20u);
+  EXPECT_LT (heap_copy.capacity (), vec.capacity ());
+  EXPECT_EQ (values (heap_copy), values (vec));
+
+  // copy and swap assignment goes through the same ctr
+  vl_vector<std::string, 4, vl_shrink_never> strs (size_t (50), "s");
+  strs.resize (2);
+  vl_vector<std::string, 4, vl_shrink_never> target;
+  target = strs;
+  EXPECT_EQ (target.capacity (), 4u);
+  EXPECT_EQ (target[1], "s");
+}
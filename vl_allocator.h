@@ -0,0 +1,426 @@
+#ifndef _VL_ALLOCATOR_H_
+#define _VL_ALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+/**
+ * allocator on top of malloc / realloc. besides the standard allocator
+ * members it has reallocate, so a vl_vector using it grows realloc style
+ * (which extends the block in place when it can, and remaps big blocks
+ * instead of copying them) for trivially relocatable elems. there is no
+ * try_expand - malloc has no way to grow a block in place without
+ * realloc, and the slack malloc_usable_size reports was never requested
+ * @tparam T the type of the allocated elems
+ */
+template<typename T>
+class vl_malloc_allocator {
+  static_assert (alignof (T) <= alignof (std::max_align_t),
+                 "malloc does not align over aligned types");
+
+ public:
+  typedef T value_type;
+
+  vl_malloc_allocator () = default;
+  template<typename U>
+  vl_malloc_allocator (const vl_malloc_allocator<U> &)
+  {}
+
+  T *allocate (size_t n)
+  {
+    void *arr = std::malloc (n * sizeof (T));
+    if (arr == nullptr)
+      throw std::bad_alloc ();
+    return static_cast<T *> (arr);
+  }
+  void deallocate (T *arr, size_t)
+  { std::free (arr); }
+  /**
+   * resizes arr to new_cap elems, moving its bytes if needed. the elems must
+   * be trivially relocatable
+   * @return the resized array
+   */
+  T *reallocate (T *arr, size_t, size_t new_cap)
+  {
+    void *new_arr = std::realloc (arr, new_cap * sizeof (T));
+    if (new_arr == nullptr)
+      throw std::bad_alloc ();
+    return static_cast<T *> (new_arr);
+  }
+};
+
+template<typename T, typename U>
+bool operator== (const vl_malloc_allocator<T> &, const vl_malloc_allocator<U> &)
+{ return true; }
+template<typename T, typename U>
+bool operator!= (const vl_malloc_allocator<T> &, const vl_malloc_allocator<U> &)
+{ return false; }
+
+/**
+ * thread local size class pool. blocks of up to max_block bytes are rounded
+ * up to a power of two class, and a freed block goes to a free list of the
+ * thread that frees it, where the next allocation of its class takes it
+ * from, without touching the global heap. each list keeps up to
+ * max_list_bytes, the rest goes back to the global heap, and all lists of a
+ * thread go back to it in bulk when the thread exits. bigger blocks go
+ * straight to the global heap
+ */
+class vl_pool {
+ public:
+  static constexpr size_t min_block = 16;
+  static constexpr size_t max_block = 64 * 1024;
+  static constexpr size_t max_list_bytes = 1024 * 1024;
+
+  /** raw memory for bytes, aligned like ::operator new */
+  static void *allocate (size_t bytes)
+  {
+    if (bytes > max_block)
+      return ::operator new (bytes);
+    size_t index = class_index (bytes);
+    thread_cache &cache = local_cache ();
+    free_block *block = cache.lists[index];
+    if (block == nullptr || cache.exited)
+      return ::operator new (min_block << index);
+    cache.lists[index] = block->next;
+    cache.counts[index]--;
+    return block;
+  }
+  /** gives back a block, bytes is the size it was allocated with */
+  static void deallocate (void *block, size_t bytes)
+  {
+    if (block == nullptr)
+      return;
+    if (bytes > max_block)
+      {
+        ::operator delete (block);
+        return;
+      }
+    size_t index = class_index (bytes);
+    thread_cache &cache = local_cache ();
+    if (cache.exited || cache.counts[index] >= max_list_bytes >> index >> 4)
+      {
+        ::operator delete (block);
+        return;
+      }
+    cache.lists[index] = ::new (block) free_block {cache.lists[index]};
+    cache.counts[index]++;
+  }
+  /** the usable size of a block allocated with bytes */
+  static size_t block_size (size_t bytes)
+  { return bytes > max_block ? bytes : min_block << class_index (bytes); }
+  /** gives all the free blocks of this thread back to the global heap */
+  static void trim ()
+  { local_cache ().release (); }
+
+ private:
+  static constexpr size_t class_count = 13; // 16 bytes to 64 KB
+
+  struct free_block {
+    free_block *next;
+  };
+  /**
+   * trivially destructible, so blocks freed by thread local objects that die
+   * after the reaper still find it, and go straight to the global heap
+   */
+  struct thread_cache {
+    free_block *lists[class_count];
+    size_t counts[class_count];
+    bool exited;
+
+    void release ()
+    {
+      for (size_t i = 0; i < class_count; ++i)
+        {
+          while (lists[i] != nullptr)
+            {
+              free_block *next = lists[i]->next;
+              ::operator delete (lists[i]);
+              lists[i] = next;
+            }
+          counts[i] = 0;
+        }
+    }
+  };
+
+  /** gives the blocks of its thread back when the thread exits */
+  struct thread_reaper {
+    thread_cache *cache;
+
+    ~thread_reaper ()
+    {
+      cache->release ();
+      cache->exited = true;
+    }
+  };
+
+  static thread_cache &local_cache ()
+  {
+    static thread_local thread_cache cache;
+    static thread_local thread_reaper reaper {&cache};
+    (void) reaper;
+    return cache;
+  }
+  static size_t class_index (size_t bytes)
+  {
+    if (bytes <= min_block)
+      return 0;
+#if defined(__GNUC__)
+    return (sizeof (unsigned long) * 8 - __builtin_clzl (bytes - 1)) - 4;
+#else
+    size_t index = 0;
+    for (size_t size = min_block; size < bytes; size <<= 1)
+      ++index;
+    return index;
+#endif
+  }
+};
+
+/**
+ * allocator on top of vl_pool. all instances are interchangeable - a block
+ * may be freed by any thread. a vl_vector using it grows in place while the
+ * new capacity still fits in the size class of its block
+ * @tparam T the type of the allocated elems
+ */
+template<typename T>
+class vl_pool_allocator {
+  static_assert (alignof (T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                 "the pool does not align over aligned types");
+
+ public:
+  typedef T value_type;
+
+  vl_pool_allocator () = default;
+  template<typename U>
+  vl_pool_allocator (const vl_pool_allocator<U> &)
+  {}
+
+  T *allocate (size_t n)
+  { return static_cast<T *> (vl_pool::allocate (n * sizeof (T))); }
+  void deallocate (T *arr, size_t n)
+  { vl_pool::deallocate (arr, n * sizeof (T)); }
+  /**
+   * grows arr to new_cap elems without moving it
+   * @return true if the block of arr already has room for new_cap elems
+   */
+  bool try_expand (T *, size_t old_cap, size_t new_cap)
+  {
+    size_t old_bytes = old_cap * sizeof (T);
+    return old_bytes <= vl_pool::max_block
+           && new_cap * sizeof (T) <= vl_pool::block_size (old_bytes);
+  }
+};
+
+template<typename T, typename U>
+bool operator== (const vl_pool_allocator<T> &, const vl_pool_allocator<U> &)
+{ return true; }
+template<typename T, typename U>
+bool operator!= (const vl_pool_allocator<T> &, const vl_pool_allocator<U> &)
+{ return false; }
+
+/**
+ * monotonic arena - hands out memory by bumping a pointer inside big
+ * chunks, and frees nothing until reset, which makes all of it reusable at
+ * once (e.g. at the end of every request). not thread safe - one arena per
+ * thread. containers using the arena must not outlive the next reset
+ */
+class vl_arena {
+ public:
+  explicit vl_arena (size_t chunk_size = 64 * 1024)
+      : _chunk_size (chunk_size), _head (nullptr), _ptr (nullptr),
+        _end (nullptr), _used (0)
+  {}
+  vl_arena (const vl_arena &) = delete;
+  vl_arena &operator= (const vl_arena &) = delete;
+  ~vl_arena ()
+  {
+    while (_head != nullptr)
+      {
+        chunk *prev = _head->prev;
+        ::operator delete (_head);
+        _head = prev;
+      }
+  }
+
+  /** bytes of memory aligned to align (a power of two) */
+  void *allocate (size_t bytes, size_t align)
+  {
+    char *block = align_up (_ptr, align);
+    // aligning may step past the end of the chunk
+    if (_head == nullptr || block > _end || bytes > size_t (_end - block))
+      {
+        add_chunk (bytes + align);
+        block = align_up (_ptr, align);
+      }
+    _ptr = block + bytes;
+    _used += bytes;
+    return block;
+  }
+  /** takes back the last block handed out, other blocks wait for reset */
+  void deallocate (void *block, size_t bytes)
+  {
+    if (static_cast<char *> (block) + bytes == _ptr)
+      {
+        _ptr = static_cast<char *> (block);
+        _used -= bytes;
+      }
+  }
+  /**
+   * grows a block without moving it
+   * @return true if block is the last one handed out and its chunk has room
+   */
+  bool try_expand (void *block, size_t old_bytes, size_t new_bytes)
+  {
+    char *old_end = static_cast<char *> (block) + old_bytes;
+    if (old_end != _ptr
+        || new_bytes - old_bytes > size_t (_end - _ptr))
+      return false;
+    _ptr = static_cast<char *> (block) + new_bytes;
+    _used += new_bytes - old_bytes;
+    return true;
+  }
+  /** frees all the blocks at once. the newest (biggest) chunk is kept */
+  void reset ()
+  {
+    if (_head == nullptr)
+      return;
+    while (_head->prev != nullptr)
+      {
+        chunk *prev = _head->prev;
+        _head->prev = prev->prev;
+        ::operator delete (prev);
+      }
+    _ptr = reinterpret_cast<char *> (_head + 1);
+    _used = 0;
+  }
+  /** bytes handed out since the last reset */
+  size_t bytes_used () const
+  { return _used; }
+
+  /** the arena of the innermost vl_arena_scope of this thread, or nullptr */
+  static vl_arena *current ()
+  { return current_slot (); }
+
+ private:
+  friend class vl_arena_scope;
+
+  struct alignas (std::max_align_t) chunk {
+    chunk *prev;
+    size_t size;
+  };
+
+  static char *align_up (char *ptr, size_t align)
+  {
+    uintptr_t addr = reinterpret_cast<uintptr_t> (ptr);
+    return ptr + ((align - addr % align) % align);
+  }
+  void add_chunk (size_t min_bytes)
+  {
+    size_t size = std::max (_chunk_size, min_bytes);
+    chunk *new_chunk =
+        static_cast<chunk *> (::operator new (sizeof (chunk) + size));
+    new_chunk->prev = _head;
+    new_chunk->size = size;
+    _head = new_chunk;
+    _ptr = reinterpret_cast<char *> (new_chunk + 1);
+    _end = _ptr + size;
+  }
+  static vl_arena *&current_slot ()
+  {
+    static thread_local vl_arena *arena = nullptr;
+    return arena;
+  }
+
+  size_t _chunk_size;
+  chunk *_head; // the newest chunk, older ones are linked through prev
+  char *_ptr; // the next free byte in the newest chunk
+  char *_end;
+  size_t _used;
+};
+
+/**
+ * makes arena the default of this thread while the scope lives - a default
+ * constructed vl_arena_allocator (and so a default constructed vl_vector or
+ * vl_string using it) takes its memory from it. scopes nest
+ */
+class vl_arena_scope {
+ public:
+  explicit vl_arena_scope (vl_arena &arena) : _prev (vl_arena::current ())
+  { vl_arena::current_slot () = &arena; }
+  vl_arena_scope (const vl_arena_scope &) = delete;
+  vl_arena_scope &operator= (const vl_arena_scope &) = delete;
+  ~vl_arena_scope ()
+  { vl_arena::current_slot () = _prev; }
+
+ private:
+  vl_arena *_prev;
+};
+
+/**
+ * allocator on top of a vl_arena. a default constructed one uses the arena
+ * of the current vl_arena_scope, or the global heap when there is none.
+ * deallocation of arena memory is (almost always) a no-op, it all comes back
+ * on reset
+ * @tparam T the type of the allocated elems
+ */
+template<typename T>
+class vl_arena_allocator {
+ public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+
+  vl_arena_allocator () : _arena (vl_arena::current ())
+  {}
+  explicit vl_arena_allocator (vl_arena &arena) : _arena (&arena)
+  {}
+  template<typename U>
+  vl_arena_allocator (const vl_arena_allocator<U> &other)
+      : _arena (other.arena ())
+  {}
+
+  T *allocate (size_t n)
+  {
+    if (_arena == nullptr)
+      return static_cast<T *> (::operator new (n * sizeof (T)));
+    return static_cast<T *> (_arena->allocate (n * sizeof (T), alignof (T)));
+  }
+  void deallocate (T *arr, size_t n)
+  {
+    if (_arena == nullptr)
+      ::operator delete (arr);
+    else
+      _arena->deallocate (arr, n * sizeof (T));
+  }
+  /**
+   * grows arr to new_cap elems without moving it
+   * @return true if arr is the last block of the arena and it has room
+   */
+  bool try_expand (T *arr, size_t old_cap, size_t new_cap)
+  {
+    return _arena != nullptr
+           && _arena->try_expand (arr, old_cap * sizeof (T),
+                                  new_cap * sizeof (T));
+  }
+  /** the arena the memory comes from, nullptr for the global heap */
+  vl_arena *arena () const
+  { return _arena; }
+
+ private:
+  vl_arena *_arena;
+};
+
+template<typename T, typename U>
+bool operator== (const vl_arena_allocator<T> &lhs,
+                 const vl_arena_allocator<U> &rhs)
+{ return lhs.arena () == rhs.arena (); }
+template<typename T, typename U>
+bool operator!= (const vl_arena_allocator<T> &lhs,
+                 const vl_arena_allocator<U> &rhs)
+{ return !(lhs == rhs); }
+
+#endif //_VL_ALLOCATOR_H_
@@ -0,0 +1,414 @@
+#ifndef _VL_CONCURRENT_VECTOR_H_
+#define _VL_CONCURRENT_VECTOR_H_
+
+#include "vl_vector.h"
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * an append only vector that many threads push to at once, without a lock.
+ * a push reserves its index with one atomic add, and the elems live in
+ * segments that never move - the first one is a static array of
+ * StaticCapacity elems inside the object, like vl_vector's, and every heap
+ * segment after it is as big as all the ones before it together. so pushes
+ * never move an elem, and references and iterators to elems stay valid until
+ * the vector dies or is cleared.
+ *
+ * size () counts the reserved indexes - an elem may be read once the push
+ * that made it returned, and that push happened before the read (joined
+ * threads, a barrier, a release / acquire pair). building an elem or a heap
+ * segment must not fail: the indexes after it may already belong to other
+ * threads, so a throw from T's ctor or from the allocator ends the program.
+ * the allocator is called from many threads at once and must allow that.
+ * clear () and the dtor must not run together with any push
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the first, static segment
+ * @tparam Allocator where the heap segments come from
+ */
+template<typename T, size_t StaticCapacity = DEF_STATIC_CAP,
+    class Allocator = std::allocator<T>>
+class vl_concurrent_vector : private Allocator {
+
+  typedef std::allocator_traits<Allocator> alloc_traits;
+  static_assert (StaticCapacity > 0,
+                 "the static segment of vl_concurrent_vector can't be empty");
+  static_assert (std::is_same<typename alloc_traits::value_type, T>::value,
+                 "the allocator must allocate T");
+
+  template<bool Const> class basic_iterator;
+
+ public:
+
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef Allocator allocator_type;
+  typedef basic_iterator<false> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+  /** def ctr */
+  explicit vl_concurrent_vector (const Allocator &alloc = Allocator ())
+      : Allocator (alloc), _size (0)
+  {
+    _segments[0].store (reinterpret_cast<T *> (_static_arr),
+                        std::memory_order_relaxed);
+    for (size_t seg = 1; seg < max_segments; ++seg)
+      _segments[seg].store (nullptr, std::memory_order_relaxed);
+  }
+  /** the elems never move, so neither does the vector */
+  vl_concurrent_vector (const vl_concurrent_vector &) = delete;
+  vl_concurrent_vector &operator= (const vl_concurrent_vector &) = delete;
+  /** destructor - no push may be running */
+  ~vl_concurrent_vector ()
+  {
+    clear ();
+    for (size_t seg = 1; seg < max_segments; ++seg)
+      {
+        T *arr = _segments[seg].load (std::memory_order_relaxed);
+        if (arr != nullptr)
+          alloc_traits::deallocate (*this, arr, segment_size (seg));
+      }
+  }
+
+  /** pushes elem, and returns the index it got. thread safe */
+  size_t push_back (const T &elem) noexcept
+  { return emplace_at (reserve_indexes (1), elem); }
+  size_t push_back (T &&elem) noexcept
+  { return emplace_at (reserve_indexes (1), std::move (elem)); }
+  /** builds an elem from args at the end, and returns it. thread safe */
+  template<class... Args>
+  T &emplace_back (Args &&... args) noexcept
+  {
+    size_t index = reserve_indexes (1);
+    emplace_at (index, std::forward<Args> (args)...);
+    return (*this)[index];
+  }
+  /**
+   * appends count copies of value in one reservation - the new elems are
+   * contiguous in index, not always in memory. thread safe
+   * @return the index of the first new elem
+   */
+  size_t grow_by (size_t count, const T &value = T ()) noexcept;
+  /**
+   * appends the elems in [first, last) in one reservation. thread safe
+   * @return the index of the first new elem
+   */
+  template<class ForwardIterator, typename = typename
+  std::iterator_traits<ForwardIterator>::iterator_category>
+  size_t grow_by (ForwardIterator first, ForwardIterator last) noexcept;
+
+  /** the number of reserved elems, see the class comment */
+  size_t size () const
+  { return _size.load (std::memory_order_acquire); }
+  bool empty () const
+  { return size () == 0; }
+  /** the number of elems that fit in the segments allocated so far */
+  size_t capacity () const;
+
+  T &operator[] (size_t index)
+  { return *slot (index); }
+  const T &operator[] (size_t index) const
+  { return *slot (index); }
+  T &at (size_t index)
+  {
+    if (index >= size ())
+      throw std::out_of_range ("Index Out of Range");
+    return *slot (index);
+  }
+  const T &at (size_t index) const
+  {
+    if (index >= size ())
+      throw std::out_of_range ("Index Out of Range");
+    return *slot (index);
+  }
+
+  iterator begin ()
+  { return iterator (this, 0); }
+  iterator end ()
+  { return iterator (this, size ()); }
+  const_iterator begin () const
+  { return const_iterator (this, 0); }
+  const_iterator end () const
+  { return const_iterator (this, size ()); }
+  const_iterator cbegin () const
+  { return begin (); }
+  const_iterator cend () const
+  { return end (); }
+
+  /**
+   * calls func (T *first, size_t count) for every run of contiguous elems,
+   * in index order - the fast way to walk all the elems
+   */
+  template<class Func>
+  void for_each_segment (Func func);
+
+  /** destroys the elems, the heap segments are kept. not thread safe */
+  void clear ();
+
+ private:
+  /** room for any size_t index */
+  static constexpr size_t max_segments = sizeof (size_t) * 8;
+
+  /** the segment index is in - the static one, then twice as big each time */
+  static size_t segment_of (size_t index)
+  {
+    if (index < StaticCapacity)
+      return 0;
+    size_t blocks = index / StaticCapacity;
+    return sizeof (unsigned long long) * 8 - __builtin_clzll (blocks);
+  }
+  /** the index of the first elem of segment seg */
+  static size_t segment_base (size_t seg)
+  { return seg == 0 ? 0 : StaticCapacity << (seg - 1); }
+  /** the number of elems in segment seg */
+  static size_t segment_size (size_t seg)
+  { return seg == 0 ? StaticCapacity : StaticCapacity << (seg - 1); }
+
+  /** reserves count indexes, and returns the first of them */
+  size_t reserve_indexes (size_t count)
+  { return _size.fetch_add (count, std::memory_order_acq_rel); }
+  /** the array of segment seg, allocated by the first thread that needs it */
+  T *segment (size_t seg);
+  /** the address of the elem at index, which must be reserved already */
+  T *slot (size_t index) const
+  {
+    size_t seg = segment_of (index);
+    return _segments[seg].load (std::memory_order_acquire)
+           + (index - segment_base (seg));
+  }
+  /** builds the elem at a reserved index */
+  template<class... Args>
+  size_t emplace_at (size_t index, Args &&... args)
+  {
+    size_t seg = segment_of (index);
+    ::new (segment (seg) + (index - segment_base (seg)))
+        T (std::forward<Args> (args)...);
+    return index;
+  }
+
+  std::atomic<size_t> _size; // the number of reserved indexes
+  std::atomic<T *> _segments[max_segments]; // nullptr until allocated
+  alignas (T) unsigned char _static_arr[StaticCapacity * sizeof (T)];
+};
+
+/**
+ * goes over the elems by index. it stays valid while the vector grows, and
+ * end () is the size when it was taken
+ * @tparam Const if the elems are read only
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+template<bool Const>
+class vl_concurrent_vector<T, StaticCapacity, Allocator>::basic_iterator {
+  typedef typename std::conditional<Const, const vl_concurrent_vector,
+                                    vl_concurrent_vector>::type vector_type;
+
+ public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef typename std::conditional<Const, const T *, T *>::type pointer;
+  typedef typename std::conditional<Const, const T &, T &>::type reference;
+
+  basic_iterator () : _vec (nullptr), _index (0)
+  {}
+  basic_iterator (vector_type *vec, size_t index) : _vec (vec), _index (index)
+  {}
+  /** a const iterator from a writable one */
+  template<bool OtherConst, typename = typename std::enable_if<
+      Const && !OtherConst>::type>
+  basic_iterator (const basic_iterator<OtherConst> &other)
+      : _vec (other._vec), _index (other._index)
+  {}
+
+  reference operator* () const
+  { return (*_vec)[_index]; }
+  pointer operator-> () const
+  { return &(*_vec)[_index]; }
+  reference operator[] (difference_type diff) const
+  { return (*_vec)[_index + diff]; }
+
+  basic_iterator &operator++ ()
+  {
+    ++_index;
+    return *this;
+  }
+  basic_iterator operator++ (int)
+  { return basic_iterator (_vec, _index++); }
+  basic_iterator &operator-- ()
+  {
+    --_index;
+    return *this;
+  }
+  basic_iterator operator-- (int)
+  { return basic_iterator (_vec, _index--); }
+  basic_iterator &operator+= (difference_type diff)
+  {
+    _index += diff;
+    return *this;
+  }
+  basic_iterator &operator-= (difference_type diff)
+  {
+    _index -= diff;
+    return *this;
+  }
+  basic_iterator operator+ (difference_type diff) const
+  { return basic_iterator (_vec, _index + diff); }
+  friend basic_iterator operator+ (difference_type diff,
+                                   const basic_iterator &it)
+  { return it + diff; }
+  basic_iterator operator- (difference_type diff) const
+  { return basic_iterator (_vec, _index - diff); }
+  difference_type operator- (const basic_iterator &other) const
+  { return static_cast<difference_type> (_index - other._index); }
+
+  bool operator== (const basic_iterator &other) const
+  { return _index == other._index; }
+  bool operator!= (const basic_iterator &other) const
+  { return _index != other._index; }
+  bool operator< (const basic_iterator &other) const
+  { return _index < other._index; }
+  bool operator> (const basic_iterator &other) const
+  { return _index > other._index; }
+  bool operator<= (const basic_iterator &other) const
+  { return _index <= other._index; }
+  bool operator>= (const basic_iterator &other) const
+  { return _index >= other._index; }
+
+ private:
+  template<bool> friend class basic_iterator;
+
+  vector_type *_vec;
+  size_t _index;
+};
+
+/**
+ * appends count copies of value with one atomic add, then builds them
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ * @param count the number of elems
+ * @param value the elem to copy
+ * @return the index of the first new elem
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+size_t vl_concurrent_vector<T, StaticCapacity, Allocator>::grow_by
+    (size_t count, const T &value) noexcept
+{
+  size_t first = reserve_indexes (count);
+  for (size_t i = 0; i < count; ++i)
+    emplace_at (first + i, value);
+  return first;
+}
+
+/**
+ * appends the elems in [first, last) with one atomic add, then builds them
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ * @tparam ForwardIterator type of iterator
+ * @param first iterator of the first elem to add
+ * @param last iterator of the last elem to add
+ * @return the index of the first new elem
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+template<class ForwardIterator, typename>
+size_t vl_concurrent_vector<T, StaticCapacity, Allocator>::grow_by
+    (ForwardIterator first, ForwardIterator last) noexcept
+{
+  size_t start = reserve_indexes (std::distance (first, last));
+  for (size_t index = start; first != last; ++first, ++index)
+    emplace_at (index, *first);
+  return start;
+}
+
+/**
+ * the number of elems that fit in the segments allocated so far - the
+ * segments are allocated in order, so it ends at the first missing one
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ * @return the capacity
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+size_t vl_concurrent_vector<T, StaticCapacity, Allocator>::capacity () const
+{
+  size_t seg = 1;
+  while (seg < max_segments
+         && _segments[seg].load (std::memory_order_acquire) != nullptr)
+    ++seg;
+  return segment_base (seg);
+}
+
+/**
+ * the array of segment seg. the first thread that needs it allocates it and
+ * publishes it with a compare and swap, a thread that loses the race frees
+ * its own array and uses the winner's
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ * @param seg the segment
+ * @return the segment's array
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+T *vl_concurrent_vector<T, StaticCapacity, Allocator>::segment (size_t seg)
+{
+  T *arr = _segments[seg].load (std::memory_order_acquire);
+  if (arr != nullptr)
+    return arr;
+  T *fresh = alloc_traits::allocate (*this, segment_size (seg));
+  if (_segments[seg].compare_exchange_strong (arr, fresh,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire))
+    return fresh;
+  alloc_traits::deallocate (*this, fresh, segment_size (seg));
+  return arr;
+}
+
+/**
+ * calls func (T *first, size_t count) for every run of contiguous elems
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ * @tparam Func a callable that takes a T * and a size_t
+ * @param func the callable
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+template<class Func>
+void vl_concurrent_vector<T, StaticCapacity, Allocator>::for_each_segment
+    (Func func)
+{
+  size_t count = size ();
+  for (size_t seg = 0; segment_base (seg) < count; ++seg)
+    {
+      size_t in_seg = std::min (segment_size (seg), count - segment_base (seg));
+      func (_segments[seg].load (std::memory_order_acquire), in_seg);
+    }
+}
+
+/**
+ * destroys the elems, keeping the heap segments for the next pushes
+ * @tparam T the elems type
+ * @tparam StaticCapacity the number of elems in the static segment
+ * @tparam Allocator where the heap segments come from
+ */
+template<typename T, size_t StaticCapacity, class Allocator>
+void vl_concurrent_vector<T, StaticCapacity, Allocator>::clear ()
+{
+  if constexpr (!std::is_trivially_destructible<T>::value)
+    for_each_segment ([] (T *first, size_t count)
+                      {
+                        for (size_t i = 0; i < count; ++i)
+                          first[i].~T ();
+                      });
+  _size.store (0, std::memory_order_release);
+}
+
+#endif //_VL_CONCURRENT_VECTOR_H_
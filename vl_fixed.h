@@ -0,0 +1,368 @@
+#ifndef _VL_FIXED_H_
+#define _VL_FIXED_H_
+
+#include "vl_hash.h"
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * a vector of at most Capacity elems, all in the object - vl_vector's static
+ * array without the heap. it is a literal type, so a vl_fixed_vector can be
+ * built, changed and searched in constant expressions, and a table made at
+ * compile time is a constant in the binary, with nothing to run at startup.
+ *
+ * constexpr in C++17 rules out placement new, so the array is a plain T
+ * array that is default constructed with the vector, and the elems are
+ * assigned into it. T must be default constructible and trivially
+ * destructible, and a literal type for constant evaluation. pushing past
+ * Capacity throws std::length_error, a compile error in a constant
+ * expression
+ * @tparam T the elems type
+ * @tparam Capacity the maximum number of elems
+ */
+template<typename T, size_t Capacity>
+class vl_fixed_vector {
+  static_assert (Capacity > 0, "a vl_fixed_vector needs room for an elem");
+  static_assert (std::is_default_constructible<T>::value
+                 && std::is_trivially_destructible<T>::value,
+                 "vl_fixed_vector assigns into a plain array of T");
+
+ public:
+  typedef T value_type;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+  typedef size_t size_type;
+
+  constexpr vl_fixed_vector () : _size (0), _arr {}
+  {}
+  constexpr vl_fixed_vector (std::initializer_list<T> elems) : vl_fixed_vector ()
+  {
+    for (const T &elem : elems)
+      push_back (elem);
+  }
+  template<class InputIterator>
+  constexpr vl_fixed_vector (InputIterator first, InputIterator last)
+      : vl_fixed_vector ()
+  {
+    for (; first != last; ++first)
+      push_back (*first);
+  }
+
+  constexpr size_t size () const
+  { return _size; }
+  static constexpr size_t capacity ()
+  { return Capacity; }
+  constexpr bool empty () const
+  { return _size == 0; }
+  constexpr T *data ()
+  { return _arr; }
+  constexpr const T *data () const
+  { return _arr; }
+  constexpr iterator begin ()
+  { return _arr; }
+  constexpr const_iterator begin () const
+  { return _arr; }
+  constexpr iterator end ()
+  { return _arr + _size; }
+  constexpr const_iterator end () const
+  { return _arr + _size; }
+
+  constexpr T &operator[] (size_t index)
+  { return _arr[index]; }
+  constexpr const T &operator[] (size_t index) const
+  { return _arr[index]; }
+  constexpr T &at (size_t index)
+  {
+    if (index >= _size)
+      throw std::out_of_range ("Index Out of Range");
+    return _arr[index];
+  }
+  constexpr const T &at (size_t index) const
+  {
+    if (index >= _size)
+      throw std::out_of_range ("Index Out of Range");
+    return _arr[index];
+  }
+  constexpr T &front ()
+  { return _arr[0]; }
+  constexpr const T &front () const
+  { return _arr[0]; }
+  constexpr T &back ()
+  { return _arr[_size - 1]; }
+  constexpr const T &back () const
+  { return _arr[_size - 1]; }
+
+  constexpr void push_back (const T &elem)
+  {
+    if (_size == Capacity)
+      throw std::length_error ("Capacity Exceeded");
+    _arr[_size++] = elem;
+  }
+  constexpr void pop_back ()
+  {
+    if (_size > 0)
+      _arr[--_size] = T ();
+  }
+  /** inserts elem before position, the elems after it move forward */
+  constexpr iterator insert (const_iterator position, const T &elem);
+  /** removes the elems of [first, last), the elems after them move back */
+  constexpr iterator erase (const_iterator first, const_iterator last);
+  constexpr iterator erase (const_iterator position)
+  { return erase (position, position + 1); }
+  constexpr void clear ()
+  { erase (begin (), end ()); }
+
+  /**
+   * search functions - linear, by ==, and value may be of any type T
+   * compares to (a vl_fixed_string table is searched by a const char *)
+   */
+  template<typename U>
+  constexpr const_iterator find (const U &value) const
+  {
+    const_iterator it = begin ();
+    while (it != end () && !(*it == value))
+      ++it;
+    return it;
+  }
+  template<typename U>
+  constexpr bool contains (const U &value) const
+  { return find (value) != end (); }
+  template<typename U>
+  constexpr size_t count (const U &value) const
+  {
+    size_t found = 0;
+    for (const T &elem : *this)
+      if (elem == value)
+        ++found;
+    return found;
+  }
+
+  /** comp operators */
+  constexpr bool operator== (const vl_fixed_vector &other) const
+  {
+    if (_size != other._size)
+      return false;
+    for (size_t i = 0; i < _size; ++i)
+      if (!(_arr[i] == other._arr[i]))
+        return false;
+    return true;
+  }
+  constexpr bool operator!= (const vl_fixed_vector &other) const
+  { return !(*this == other); }
+
+ private:
+  size_t _size;
+  T _arr[Capacity];
+};
+
+/**
+ * inserts an elem - the elems after position are assigned one place
+ * forward from the back
+ * @tparam T the elems type
+ * @tparam Capacity the maximum number of elems
+ * @param position where the elem goes
+ * @param elem the elem to insert
+ * @return iterator of the inserted elem
+ */
+template<typename T, size_t Capacity>
+constexpr typename vl_fixed_vector<T, Capacity>::iterator
+vl_fixed_vector<T, Capacity>::insert (const_iterator position, const T &elem)
+{
+  size_t index = position - begin ();
+  if (_size == Capacity)
+    throw std::length_error ("Capacity Exceeded");
+  T copy = elem; // elem may be in the array
+  for (size_t i = _size; i > index; --i)
+    _arr[i] = _arr[i - 1];
+  _arr[index] = copy;
+  ++_size;
+  return begin () + index;
+}
+
+/**
+ * removes a range of elems - the elems after it are assigned back over it,
+ * and the freed places get default values
+ * @tparam T the elems type
+ * @tparam Capacity the maximum number of elems
+ * @param first the first elem to remove
+ * @param last the end of the elems to remove
+ * @return iterator of the elem after the removed ones
+ */
+template<typename T, size_t Capacity>
+constexpr typename vl_fixed_vector<T, Capacity>::iterator
+vl_fixed_vector<T, Capacity>::erase (const_iterator first, const_iterator last)
+{
+  size_t index = first - begin ();
+  size_t count = last - first;
+  for (size_t i = index; i + count < _size; ++i)
+    _arr[i] = _arr[i + count];
+  for (size_t i = _size - count; i < _size; ++i)
+    _arr[i] = T ();
+  _size -= count;
+  return begin () + index;
+}
+
+/**
+ * a string of at most Capacity chars in the object, always null terminated
+ * - the vl_fixed_vector of chars. it is a literal type: keyword tables,
+ * names and formats can be built and searched at compile time, a
+ * vl_fixed_string ("while") is a vl_fixed_string<5>. it converts to
+ * std::string_view, so vl_sv, vl_string_hash / vl_string_equal and
+ * vl_intern_pool take it like any other string, and hashing it gives what
+ * hashing the same chars in a vl_string does
+ * @tparam Capacity the maximum number of chars, the terminator not counted
+ */
+template<size_t Capacity>
+class vl_fixed_string {
+ public:
+  typedef char value_type;
+  typedef char *iterator;
+  typedef const char *const_iterator;
+  typedef size_t size_type;
+  static constexpr size_t npos = std::string_view::npos;
+
+  constexpr vl_fixed_string () : _size (0), _chars {}
+  {}
+  /** a string literal - one longer than Capacity doesn't compile */
+  template<size_t Size>
+  constexpr vl_fixed_string (const char (&str)[Size]) : vl_fixed_string ()
+  {
+    static_assert (Size - 1 <= Capacity, "the literal is longer than Capacity");
+    append (std::string_view (str, Size - 1));
+  }
+  /** the chars of a view, std::length_error if they don't fit */
+  constexpr explicit vl_fixed_string (std::string_view str) : vl_fixed_string ()
+  { append (str); }
+
+  constexpr size_t size () const
+  { return _size; }
+  constexpr size_t length () const
+  { return _size; }
+  static constexpr size_t capacity ()
+  { return Capacity; }
+  constexpr bool empty () const
+  { return _size == 0; }
+  constexpr const char *data () const
+  { return _chars; }
+  constexpr const char *c_str () const
+  { return _chars; }
+  constexpr iterator begin ()
+  { return _chars; }
+  constexpr const_iterator begin () const
+  { return _chars; }
+  constexpr iterator end ()
+  { return _chars + _size; }
+  constexpr const_iterator end () const
+  { return _chars + _size; }
+  constexpr char &operator[] (size_t index)
+  { return _chars[index]; }
+  constexpr const char &operator[] (size_t index) const
+  { return _chars[index]; }
+  constexpr std::string_view sv () const
+  { return std::string_view (_chars, _size); }
+  constexpr operator std::string_view () const
+  { return sv (); }
+
+  constexpr void push_back (char single_char)
+  {
+    if (_size == Capacity)
+      throw std::length_error ("Capacity Exceeded");
+    _chars[_size++] = single_char;
+  }
+  constexpr void pop_back ()
+  {
+    if (_size > 0)
+      _chars[--_size] = '\0';
+  }
+  constexpr vl_fixed_string &append (std::string_view str)
+  {
+    if (str.size () > Capacity - _size)
+      throw std::length_error ("Capacity Exceeded");
+    for (char single_char : str)
+      _chars[_size++] = single_char;
+    return *this;
+  }
+  constexpr vl_fixed_string &operator+= (std::string_view str)
+  { return append (str); }
+  constexpr vl_fixed_string &operator+= (char single_char)
+  {
+    push_back (single_char);
+    return *this;
+  }
+  constexpr void clear ()
+  {
+    while (_size > 0)
+      _chars[--_size] = '\0';
+  }
+
+  /** search functions - positions of chars / substrings, or npos */
+  constexpr size_t find (std::string_view substr, size_t pos = 0) const
+  { return sv ().find (substr, pos); }
+  constexpr size_t find (char single_char, size_t pos = 0) const
+  { return sv ().find (single_char, pos); }
+  constexpr bool contains (std::string_view substr) const
+  { return find (substr) != npos; }
+  constexpr bool contains (char single_char) const
+  { return find (single_char) != npos; }
+  constexpr bool starts_with (std::string_view prefix) const
+  { return sv ().substr (0, prefix.size ()) == prefix; }
+  constexpr bool ends_with (std::string_view suffix) const
+  {
+    return _size >= suffix.size ()
+           && sv ().substr (_size - suffix.size ()) == suffix;
+  }
+
+  /** the chars compare as unsigned, like std::string */
+  constexpr int compare (std::string_view other) const
+  { return sv ().compare (other); }
+
+  /** comp operators - against fixed strings of any capacity and c strings */
+  template<size_t OtherCapacity>
+  friend constexpr bool operator== (const vl_fixed_string &lhs,
+                                    const vl_fixed_string<OtherCapacity> &rhs)
+  { return lhs.sv () == rhs.sv (); }
+  friend constexpr bool operator== (const vl_fixed_string &lhs, const char *rhs)
+  { return lhs.sv () == rhs; }
+  friend constexpr bool operator== (const char *lhs, const vl_fixed_string &rhs)
+  { return rhs.sv () == lhs; }
+  template<size_t OtherCapacity>
+  friend constexpr bool operator!= (const vl_fixed_string &lhs,
+                                    const vl_fixed_string<OtherCapacity> &rhs)
+  { return lhs.sv () != rhs.sv (); }
+  friend constexpr bool operator!= (const vl_fixed_string &lhs, const char *rhs)
+  { return lhs.sv () != rhs; }
+  friend constexpr bool operator!= (const char *lhs, const vl_fixed_string &rhs)
+  { return rhs.sv () != lhs; }
+  template<size_t OtherCapacity>
+  friend constexpr bool operator< (const vl_fixed_string &lhs,
+                                   const vl_fixed_string<OtherCapacity> &rhs)
+  { return lhs.sv () < rhs.sv (); }
+  friend constexpr bool operator< (const vl_fixed_string &lhs, const char *rhs)
+  { return lhs.sv () < rhs; }
+  friend constexpr bool operator< (const char *lhs, const vl_fixed_string &rhs)
+  { return std::string_view (lhs) < rhs.sv (); }
+
+ private:
+  size_t _size;
+  char _chars[Capacity + 1]; // the last one stays '\0'
+};
+
+/** vl_fixed_string ("while") is a vl_fixed_string<5> */
+template<size_t Size>
+vl_fixed_string (const char (&str)[Size]) -> vl_fixed_string<Size - 1>;
+
+namespace std {
+template<size_t Capacity>
+struct hash<vl_fixed_string<Capacity>> {
+  size_t operator() (const vl_fixed_string<Capacity> &str) const
+  { return vl_hash_bytes (str.data (), str.size ()); }
+};
+}
+
+#endif //_VL_FIXED_H_
@@ -0,0 +1,180 @@
+#ifndef _VL_HASH_H_
+#define _VL_HASH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+/**
+ * hashing and ordering of elem arrays, for vl_vector / vl_string keys. the
+ * bytes are hashed in bulk with wyhash (final version 4, public domain) -
+ * 48 bytes per step, two 64 bit multiplies each, and short keys in a few
+ * loads. it is not a cryptographic hash, so it doesn't stop keys made to
+ * collide on purpose
+ */
+
+/** the wyhash constants */
+constexpr uint64_t vl_wy_secret[4] = {0x2d358dccaa6c78a5ull,
+                                      0x8bb84b93962eacc9ull,
+                                      0x4b33a62ed433d4a3ull,
+                                      0x4d5a2da51de1aa47ull};
+
+/** the 128 bit product of a and b - low half to a, high half to b */
+inline void vl_wy_mum (uint64_t &a, uint64_t &b)
+{
+  __uint128_t product = static_cast<__uint128_t> (a) * b;
+  a = static_cast<uint64_t> (product);
+  b = static_cast<uint64_t> (product >> 64);
+}
+/** the two halves of a * b, xored */
+inline uint64_t vl_wy_mix (uint64_t a, uint64_t b)
+{
+  vl_wy_mum (a, b);
+  return a ^ b;
+}
+/** reads 8 / 4 bytes, not aligned */
+inline uint64_t vl_wy_read8 (const unsigned char *p)
+{
+  uint64_t v;
+  std::memcpy (&v, p, sizeof (v));
+  return v;
+}
+inline uint64_t vl_wy_read4 (const unsigned char *p)
+{
+  uint32_t v;
+  std::memcpy (&v, p, sizeof (v));
+  return v;
+}
+
+/**
+ * the hash of len bytes
+ * @param data the bytes
+ * @param len the number of bytes
+ * @param seed changes the hash of every key
+ */
+inline uint64_t vl_hash_bytes (const void *data, size_t len, uint64_t seed = 0)
+{
+  const unsigned char *p = static_cast<const unsigned char *> (data);
+  seed ^= vl_wy_mix (seed ^ vl_wy_secret[0], vl_wy_secret[1]);
+  uint64_t a;
+  uint64_t b;
+  if (len <= 16)
+    {
+      if (len >= 4)
+        { // the first and the last 4 bytes, and 4 from the middle of each half
+          size_t mid = (len >> 3) << 2;
+          a = (vl_wy_read4 (p) << 32) | vl_wy_read4 (p + mid);
+          b = (vl_wy_read4 (p + len - 4) << 32)
+              | vl_wy_read4 (p + len - 4 - mid);
+        }
+      else if (len > 0)
+        {
+          a = (uint64_t (p[0]) << 16) | (uint64_t (p[len >> 1]) << 8)
+              | p[len - 1];
+          b = 0;
+        }
+      else
+        a = b = 0;
+    }
+  else
+    {
+      size_t left = len;
+      if (left > 48)
+        { // three independent lanes
+          uint64_t seed1 = seed;
+          uint64_t seed2 = seed;
+          do
+            {
+              seed = vl_wy_mix (vl_wy_read8 (p) ^ vl_wy_secret[1],
+                                vl_wy_read8 (p + 8) ^ seed);
+              seed1 = vl_wy_mix (vl_wy_read8 (p + 16) ^ vl_wy_secret[2],
+                                 vl_wy_read8 (p + 24) ^ seed1);
+              seed2 = vl_wy_mix (vl_wy_read8 (p + 32) ^ vl_wy_secret[3],
+                                 vl_wy_read8 (p + 40) ^ seed2);
+              p += 48;
+              left -= 48;
+            }
+          while (left > 48);
+          seed ^= seed1 ^ seed2;
+        }
+      while (left > 16)
+        {
+          seed = vl_wy_mix (vl_wy_read8 (p) ^ vl_wy_secret[1],
+                            vl_wy_read8 (p + 8) ^ seed);
+          p += 16;
+          left -= 16;
+        }
+      // the last 16 bytes, some of them maybe hashed already
+      a = vl_wy_read8 (p + left - 16);
+      b = vl_wy_read8 (p + left - 8);
+    }
+  a ^= vl_wy_secret[1];
+  b ^= seed;
+  vl_wy_mum (a, b);
+  return vl_wy_mix (a ^ vl_wy_secret[0] ^ len, b ^ vl_wy_secret[1]);
+}
+
+/**
+ * the hash of n elems. types whose equal values have equal bytes are hashed
+ * as bytes in bulk, others by mixing the std::hash of every elem
+ * @tparam T the elems type
+ */
+template<typename T>
+size_t vl_hash_range (const T *arr, size_t n)
+{
+  if constexpr (std::has_unique_object_representations<T>::value)
+    return vl_hash_bytes (arr, n * sizeof (T));
+  else
+    {
+      uint64_t seed = vl_wy_mix (n ^ vl_wy_secret[0], vl_wy_secret[1]);
+      std::hash<T> hasher;
+      for (size_t i = 0; i < n; ++i)
+        seed = vl_wy_mix (seed ^ vl_wy_secret[2],
+                          uint64_t (hasher (arr[i])) ^ vl_wy_secret[3]);
+      return seed;
+    }
+}
+
+/**
+ * tells if memcmp orders arrays of T like comparing them elem by elem does -
+ * true for one byte unsigned types. wider integers are little endian, and
+ * signed bytes compare below 0 as bigger
+ * @tparam T the elems type
+ */
+template<typename T>
+struct vl_is_memcmp_ordered
+    : std::integral_constant<bool, sizeof (T) == 1
+                                   && (std::is_unsigned<T>::value
+                                       || std::is_same<T, std::byte>::value)> {
+};
+
+/**
+ * compares two arrays lexicographically, like std::lexicographical_compare
+ * @tparam T the elems type
+ * @return < 0 if lhs comes first, 0 if they are equal, > 0 if rhs does
+ */
+template<typename T>
+int vl_compare (const T *lhs, size_t lhs_size, const T *rhs, size_t rhs_size)
+{
+  size_t common = std::min (lhs_size, rhs_size);
+  if constexpr (vl_is_memcmp_ordered<T>::value)
+    {
+      int result = common == 0 ? 0 : std::memcmp (lhs, rhs, common);
+      if (result != 0)
+        return result;
+    }
+  else
+    for (size_t i = 0; i < common; ++i)
+      {
+        if (lhs[i] < rhs[i])
+          return -1;
+        if (rhs[i] < lhs[i])
+          return 1;
+      }
+  return lhs_size < rhs_size ? -1 : lhs_size > rhs_size ? 1 : 0;
+}
+
+#endif //_VL_HASH_H_
@@ -0,0 +1,329 @@
+#ifndef _VL_INTERN_H_
+#define _VL_INTERN_H_
+
+#include "vl_allocator.h"
+#include "vl_concurrent_vector.h"
+#include "vl_hash.h"
+#include "vl_string.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * a handle of an interned string - 4 bytes, and two handles from the same
+ * vl_intern_pool are equal exactly when their strings are, so comparing
+ * them is an integer compare. the chars are the pool's view () of it. a
+ * default constructed handle is of no string
+ */
+class vl_interned {
+ public:
+  vl_interned () : _id (invalid_id)
+  {}
+  explicit vl_interned (uint32_t id) : _id (id)
+  {}
+
+  /** the index of the string in its pool, in interning order */
+  uint32_t id () const
+  { return _id; }
+  bool valid () const
+  { return _id != invalid_id; }
+
+  /** comp operators - by id, not by the chars */
+  bool operator== (vl_interned other) const
+  { return _id == other._id; }
+  bool operator!= (vl_interned other) const
+  { return _id != other._id; }
+  bool operator< (vl_interned other) const
+  { return _id < other._id; }
+
+ private:
+  static constexpr uint32_t invalid_id = ~uint32_t (0);
+
+  uint32_t _id;
+};
+
+namespace std {
+template<>
+struct hash<vl_interned> {
+  size_t operator() (vl_interned handle) const
+  { return handle.id (); }
+};
+}
+
+/**
+ * a table of interned strings - every distinct string is kept once, for as
+ * long as the pool lives, and is known by a vl_interned handle. the chars
+ * are copied to arenas and never move, so view () and intern_view () give
+ * string views that stay valid (and null terminated) with the pool, and two
+ * of them are of the same string exactly when their data () are equal.
+ *
+ * intern, find and view are thread safe. the table is split in shards by
+ * hash, each with its own lock and arena - finding a string that is there
+ * already takes a shared lock of its shard, and view () takes none. the
+ * entries behind the handles are in a vl_concurrent_vector, a handle may be
+ * looked at by any thread that got it from the pool or from a thread that
+ * did
+ */
+class vl_intern_pool {
+ public:
+  /** the number of shards, a power of two */
+  static constexpr size_t shard_count = 16;
+
+  vl_intern_pool () = default;
+  vl_intern_pool (const vl_intern_pool &) = delete;
+  vl_intern_pool &operator= (const vl_intern_pool &) = delete;
+
+  /** a pool for the whole program, never destroyed */
+  static vl_intern_pool &global ()
+  {
+    static vl_intern_pool *pool = new vl_intern_pool;
+    return *pool;
+  }
+
+  /** the handle of str, interning it if it is new. thread safe */
+  vl_interned intern (std::string_view str);
+  template<size_t StaticCapacity, class Allocator>
+  vl_interned intern (const vl_string<StaticCapacity, Allocator> &str)
+  { return intern (str.sv ()); }
+  /** the pool's copy of str, interning it if it is new. thread safe */
+  std::string_view intern_view (std::string_view str)
+  { return view (intern (str)); }
+  /**
+   * interns the strings of [first, last) - any string type - and writes
+   * their handles to out, in order. each shard is locked once for all of
+   * them. thread safe
+   * @return the end of the handles written
+   */
+  template<class InputIterator, class OutputIterator>
+  OutputIterator intern_all (InputIterator first, InputIterator last,
+                             OutputIterator out);
+  /** interns the fields of buffer between delims, see intern_all */
+  template<class OutputIterator>
+  OutputIterator intern_split (std::string_view buffer, char delim,
+                               OutputIterator out)
+  {
+    vl_split_view fields (buffer, delim);
+    return intern_all (fields.begin (), fields.end (), out);
+  }
+
+  /** the handle of str if it is interned, an invalid one if not */
+  vl_interned find (std::string_view str) const;
+  /** the chars of an interned string */
+  std::string_view view (vl_interned handle) const
+  {
+    const entry &interned = _entries[handle.id ()];
+    return std::string_view (interned.chars, interned.size);
+  }
+  const char *c_str (vl_interned handle) const
+  { return _entries[handle.id ()].chars; }
+
+  /** the number of strings interned */
+  size_t size () const
+  { return _entries.size (); }
+  /** the bytes the interned chars take, terminators included */
+  size_t bytes_used () const
+  {
+    size_t used = 0;
+    for (const shard &part : _shards)
+      {
+        std::shared_lock<std::shared_mutex> lock (part.mutex);
+        used += part.arena.bytes_used ();
+      }
+    return used;
+  }
+
+ private:
+  /** an interned string */
+  struct entry {
+    const char *chars;
+    uint32_t size;
+  };
+  /** a place in a shard's open addressing table */
+  struct slot {
+    uint32_t tag; // the low half of the hash, grow () rehashes from it
+    uint32_t id; // invalid_id if the slot is empty
+  };
+  static constexpr uint32_t invalid_id = ~uint32_t (0);
+  static constexpr size_t min_slots = 64;
+
+  struct alignas (64) shard {
+    shard () : arena (16 * 1024)
+    {}
+
+    mutable std::shared_mutex mutex;
+    vl_arena arena;
+    std::unique_ptr<slot[]> slots;
+    size_t mask = 0; // the number of slots - 1
+    size_t count = 0;
+  };
+
+  static uint64_t hash_of (std::string_view str)
+  { return vl_hash_bytes (str.data (), str.size ()); }
+  /** the shard of a hash - by its high bits, the slot is by the low ones */
+  static size_t shard_of (uint64_t hash)
+  { return hash >> (64 - __builtin_ctzll (shard_count)); }
+
+  /**
+   * the slot of str in part, or the empty slot where it would go. the lock
+   * of part is held
+   */
+  const slot *lookup (const shard &part, std::string_view str,
+                      uint64_t hash) const;
+  /** the handle of str in part, interning it if it is new - under the
+   * unique lock of part */
+  vl_interned intern_locked (shard &part, std::string_view str,
+                             uint64_t hash);
+  /** doubles the table of part */
+  void grow (shard &part);
+
+  shard _shards[shard_count];
+  vl_concurrent_vector<entry, 64> _entries;
+};
+
+inline const vl_intern_pool::slot *
+vl_intern_pool::lookup (const shard &part, std::string_view str,
+                        uint64_t hash) const
+{
+  if (part.slots == nullptr)
+    return nullptr;
+  uint32_t tag = static_cast<uint32_t> (hash);
+  for (size_t i = hash & part.mask;; i = (i + 1) & part.mask)
+    {
+      const slot &place = part.slots[i];
+      if (place.id == invalid_id)
+        return &place;
+      if (place.tag == tag && view (vl_interned (place.id)) == str)
+        return &place;
+    }
+}
+
+inline vl_interned vl_intern_pool::find (std::string_view str) const
+{
+  uint64_t hash = hash_of (str);
+  const shard &part = _shards[shard_of (hash)];
+  std::shared_lock<std::shared_mutex> lock (part.mutex);
+  const slot *place = lookup (part, str, hash);
+  return place == nullptr ? vl_interned () : vl_interned (place->id);
+}
+
+inline vl_interned vl_intern_pool::intern (std::string_view str)
+{
+  uint64_t hash = hash_of (str);
+  shard &part = _shards[shard_of (hash)];
+  {
+    std::shared_lock<std::shared_mutex> lock (part.mutex);
+    const slot *place = lookup (part, str, hash);
+    if (place != nullptr && place->id != invalid_id)
+      return vl_interned (place->id);
+  }
+  std::unique_lock<std::shared_mutex> lock (part.mutex);
+  return intern_locked (part, str, hash);
+}
+
+/**
+ * interns strings in bulk - they are hashed first and sorted by shard, so
+ * every shard they go to is locked once
+ * @tparam InputIterator iterator of strings vl_sv takes
+ * @tparam OutputIterator takes vl_interned handles
+ * @param first the first string
+ * @param last the end of the strings
+ * @param out where the handles go
+ * @return the end of the handles written
+ */
+template<class InputIterator, class OutputIterator>
+OutputIterator
+vl_intern_pool::intern_all (InputIterator first, InputIterator last,
+                            OutputIterator out)
+{
+  struct pending {
+    std::string_view str;
+    uint64_t hash;
+  };
+  vl_vector<pending, 64> strs;
+  size_t counts[shard_count + 1] = {};
+  for (; first != last; ++first)
+    {
+      std::string_view str = vl_sv (*first);
+      uint64_t hash = hash_of (str);
+      strs.push_back ({str, hash});
+      ++counts[shard_of (hash) + 1];
+    }
+  // counting sort of the indexes by shard
+  for (size_t i = 1; i <= shard_count; ++i)
+    counts[i] += counts[i - 1];
+  vl_vector<uint32_t, 64> order (strs.size (), 0);
+  size_t next[shard_count];
+  std::copy (counts, counts + shard_count, next);
+  for (size_t i = 0; i < strs.size (); ++i)
+    order[next[shard_of (strs[i].hash)]++] = static_cast<uint32_t> (i);
+
+  vl_vector<vl_interned, 64> handles (strs.size (), vl_interned ());
+  for (size_t part_index = 0; part_index < shard_count; ++part_index)
+    {
+      if (counts[part_index] == counts[part_index + 1])
+        continue;
+      shard &part = _shards[part_index];
+      std::unique_lock<std::shared_mutex> lock (part.mutex);
+      for (size_t i = counts[part_index]; i < counts[part_index + 1]; ++i)
+        {
+          const pending &str = strs[order[i]];
+          handles[order[i]] = intern_locked (part, str.str, str.hash);
+        }
+    }
+  return std::copy (handles.begin (), handles.end (), out);
+}
+
+inline vl_interned
+vl_intern_pool::intern_locked (shard &part, std::string_view str,
+                               uint64_t hash)
+{
+  const slot *found = lookup (part, str, hash);
+  if (found != nullptr && found->id != invalid_id)
+    return vl_interned (found->id);
+  if (str.size () >= invalid_id)
+    throw std::length_error ("String Too Long to Intern");
+  if ((part.count + 1) * 4 > (part.mask + 1) * 3)
+    grow (part);
+  size_t id = _entries.size ();
+  if (id >= invalid_id)
+    throw std::length_error ("Too Many Interned Strings");
+
+  char *chars = static_cast<char *> (part.arena.allocate (str.size () + 1, 1));
+  std::memcpy (chars, str.data (), str.size ());
+  chars[str.size ()] = '\0';
+  id = _entries.push_back ({chars, static_cast<uint32_t> (str.size ())});
+  // the empty slot lookup stops at - found again, the table may have grown
+  slot *place = const_cast<slot *> (lookup (part, str, hash));
+  *place = {static_cast<uint32_t> (hash), static_cast<uint32_t> (id)};
+  ++part.count;
+  return vl_interned (static_cast<uint32_t> (id));
+}
+
+inline void vl_intern_pool::grow (shard &part)
+{
+  size_t new_size = part.slots == nullptr ? min_slots : 2 * (part.mask + 1);
+  std::unique_ptr<slot[]> new_slots (new slot[new_size]);
+  for (size_t i = 0; i < new_size; ++i)
+    new_slots[i] = {0, invalid_id};
+  size_t new_mask = new_size - 1;
+  for (size_t i = 0; part.slots != nullptr && i <= part.mask; ++i)
+    {
+      const slot &place = part.slots[i];
+      if (place.id == invalid_id)
+        continue;
+      // the tag is the low half of the hash, and so has the slot bits
+      size_t j = place.tag & new_mask;
+      while (new_slots[j].id != invalid_id)
+        j = (j + 1) & new_mask;
+      new_slots[j] = place;
+    }
+  part.slots = std::move (new_slots);
+  part.mask = new_mask;
+}
+
+#endif //_VL_INTERN_H_
@@ -0,0 +1,434 @@
+#ifndef _VL_JAGGED_H_
+#define _VL_JAGGED_H_
+
+#include "vl_vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * many small vectors in one container - adjacency lists, tags per record.
+ * vl_vector's static array idea at the collection level: every row has
+ * RowCapacity inline slots, and the slots of all the rows are one
+ * contiguous array, so walking the rows in order walks memory in order. a
+ * row that outgrows its slots spills alone to a block of the shared
+ * overflow array, that grows 2x per spill. a block left behind when its row
+ * moves to a bigger one is a hole until compact (), which packs the
+ * overflow array in row order and brings back inline the rows that fit
+ * again.
+ *
+ * the elems are plain data (trivially copyable) - they are moved with
+ * memcpy and never destroyed. a row is reached through a row view, whose
+ * pointers and iterators stay valid until a row is added, a row spills or
+ * grows its block, or compact () runs
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ */
+template<typename T, size_t RowCapacity = DEF_STATIC_CAP,
+    class Allocator = std::allocator<T>>
+class vl_jagged {
+  static_assert (std::is_trivially_copyable<T>::value,
+                 "vl_jagged keeps plain data, T must be trivially copyable");
+  static_assert (RowCapacity > 0, "the rows of vl_jagged need inline slots");
+
+  /** where the elems of a row are */
+  struct row_info {
+    size_t offset; // in the inline slots, or in the overflow array if cap
+    uint32_t size;
+    uint32_t cap; // 0 while the row is inline
+  };
+
+  typedef vl_vector<T, 0, vl_shrink_never, vl_growth_1_5x, Allocator> array;
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<
+      row_info> row_allocator;
+
+  template<bool Const> class basic_row;
+
+ public:
+  typedef T value_type;
+  typedef basic_row<false> row_type;
+  typedef basic_row<true> const_row_type;
+
+  /** an empty container, without rows */
+  explicit vl_jagged (const Allocator &alloc = Allocator ())
+      : _slots (alloc), _overflow (alloc), _rows (row_allocator (alloc)),
+        _overflow_used (0)
+  {}
+  /** rows empty rows */
+  explicit vl_jagged (size_t rows, const Allocator &alloc = Allocator ())
+      : vl_jagged (alloc)
+  { resize (rows); }
+
+  /** the number of rows */
+  size_t size () const
+  { return _rows.size (); }
+  bool empty () const
+  { return _rows.empty (); }
+  /** a view of a row */
+  row_type operator[] (size_t row)
+  { return row_type (this, row); }
+  const_row_type operator[] (size_t row) const
+  { return const_row_type (this, row); }
+  /** a view of a row, checked */
+  row_type at (size_t row)
+  {
+    if (row >= size ())
+      throw std::out_of_range ("Index Out of Range");
+    return (*this)[row];
+  }
+  const_row_type at (size_t row) const
+  {
+    if (row >= size ())
+      throw std::out_of_range ("Index Out of Range");
+    return (*this)[row];
+  }
+
+  /** appends an empty row, and returns its index */
+  size_t add_row ();
+  /** appends a row of the elems in [first, last), and returns its index */
+  template<class InputIterator>
+  size_t add_row (InputIterator first, InputIterator last);
+  /** adds empty rows or removes rows from the end */
+  void resize (size_t rows);
+  /** makes room for rows rows without growing the inline slots */
+  void reserve (size_t rows)
+  {
+    _rows.reserve (rows);
+    _slots.reserve (rows * RowCapacity);
+  }
+  /** removes all the rows, the memory is kept */
+  void clear ()
+  {
+    _rows.clear ();
+    _slots.clear ();
+    _overflow.clear ();
+    _overflow_used = 0;
+  }
+
+  /**
+   * brings back inline the spilled rows that fit in their slots, and packs
+   * the others in the overflow array in row order, each in a block of its
+   * size - no holes and no spare room
+   */
+  void compact ();
+
+  /** the number of rows in the overflow array */
+  size_t spilled_rows () const
+  {
+    return std::count_if (_rows.begin (), _rows.end (),
+                          [] (const row_info &info) { return info.cap != 0; });
+  }
+  /** the elems the overflow array holds, counting holes and spare room */
+  size_t overflow_size () const
+  { return _overflow.size (); }
+  /** the elems of the overflow array that belong to a row's block */
+  size_t overflow_used () const
+  { return _overflow_used; }
+
+ private:
+  T *row_data (const row_info &info)
+  {
+    return (info.cap == 0 ? _slots.data () : _overflow.data ())
+           + info.offset;
+  }
+  const T *row_data (const row_info &info) const
+  {
+    return (info.cap == 0 ? _slots.data () : _overflow.data ())
+           + info.offset;
+  }
+  static size_t row_capacity (const row_info &info)
+  { return info.cap == 0 ? RowCapacity : info.cap; }
+  /** gives a row a block of new_cap elems */
+  void grow_row (row_info &info, size_t new_cap);
+  /** appends elem to a row */
+  void push_back (size_t row, T elem)
+  {
+    row_info &info = _rows[row];
+    if (info.size == row_capacity (info))
+      grow_row (info, 2 * row_capacity (info));
+    row_data (info)[info.size++] = elem;
+  }
+
+  array _slots; // RowCapacity slots per row, in row order
+  array _overflow; // the blocks of the spilled rows, and holes
+  vl_vector<row_info, 0, vl_shrink_never, vl_growth_1_5x,
+            row_allocator> _rows;
+  size_t _overflow_used;
+};
+
+/**
+ * a view of a row of a vl_jagged, with the vl_vector api for one row. it is
+ * an index and the container, so it stays valid as long as the row does
+ * @tparam Const true for a read only view
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+template<bool Const>
+class vl_jagged<T, RowCapacity, Allocator>::basic_row {
+  typedef typename std::conditional<Const, const vl_jagged,
+                                    vl_jagged>::type container;
+  typedef typename std::conditional<Const, const T, T>::type elem;
+
+ public:
+  typedef T value_type;
+  typedef elem *iterator;
+  typedef const T *const_iterator;
+
+  basic_row (container *jagged, size_t row) : _jagged (jagged), _row (row)
+  {}
+  /** a read only view of a writable one, or a copy */
+  basic_row (const basic_row<false> &other)
+      : _jagged (other._jagged), _row (other._row)
+  {}
+  basic_row &operator= (const basic_row &) = default;
+
+  /** the index of the row */
+  size_t index () const
+  { return _row; }
+
+  size_t size () const
+  { return info ().size; }
+  bool empty () const
+  { return size () == 0; }
+  /** the elems that fit before the row needs a new block */
+  size_t capacity () const
+  { return row_capacity (info ()); }
+  /** tells if the row is in the overflow array */
+  bool spilled () const
+  { return info ().cap != 0; }
+
+  elem *data () const
+  { return _jagged->row_data (info ()); }
+  iterator begin () const
+  { return data (); }
+  iterator end () const
+  { return data () + size (); }
+  elem &operator[] (size_t index) const
+  { return data ()[index]; }
+  elem &at (size_t index) const
+  {
+    if (index >= size ())
+      throw std::out_of_range ("Index Out of Range");
+    return data ()[index];
+  }
+  elem &front () const
+  { return data ()[0]; }
+  elem &back () const
+  { return data ()[size () - 1]; }
+  vl_span<elem> as_span () const
+  { return vl_span<elem> (data (), size ()); }
+
+  /** search functions - vectorized for arithmetic types, like vl_vector's */
+  iterator find (const T &value) const
+  { return begin () + find_index (value); }
+  bool contains (const T &value) const
+  { return find_index (value) != size (); }
+  size_t count (const T &value) const
+  {
+    if constexpr (vl_simd_supported<T>::value)
+      return vl_simd_count (data (), size (), value);
+    else
+      return std::count (begin (), end (), value);
+  }
+
+  /** appends elem - it may be an elem of any row */
+  void push_back (const T &value) const
+  { _jagged->push_back (_row, value); }
+  /** appends the elems in [first, last) */
+  template<class InputIterator>
+  void append (InputIterator first, InputIterator last) const
+  {
+    for (; first != last; ++first)
+      push_back (*first);
+  }
+  void pop_back () const
+  {
+    if (size () > 0)
+      --mutable_info ().size;
+  }
+  /** removes an elem, the ones after it move back */
+  iterator erase (const_iterator position) const
+  {
+    T *arr = data ();
+    size_t index = position - arr;
+    std::memmove (static_cast<void *> (arr + index),
+                  static_cast<const void *> (arr + index + 1),
+                  (size () - index - 1) * sizeof (T));
+    --mutable_info ().size;
+    return arr + index;
+  }
+  /** empties the row, a spilled row keeps its block until compact () */
+  void clear () const
+  { mutable_info ().size = 0; }
+
+ private:
+  const row_info &info () const
+  { return _jagged->_rows[_row]; }
+  row_info &mutable_info () const
+  { return _jagged->_rows[_row]; }
+  size_t find_index (const T &value) const
+  {
+    if constexpr (vl_simd_supported<T>::value)
+      return vl_simd_find (data (), size (), value);
+    else
+      return std::find (begin (), end (), value) - begin ();
+  }
+
+  template<bool> friend class basic_row;
+
+  container *_jagged;
+  size_t _row;
+};
+
+/**
+ * appends an empty row - its inline slots are added to the slots array
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ * @return the index of the row
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+size_t vl_jagged<T, RowCapacity, Allocator>::add_row ()
+{
+  size_t offset = _slots.size ();
+  _slots.resize_for_overwrite (offset + RowCapacity);
+  _rows.push_back ({offset, 0, 0});
+  return _rows.size () - 1;
+}
+
+/**
+ * appends a row of the elems in [first, last) - a forward range that
+ * doesn't fit inline gets a block of exactly its size
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ * @tparam InputIterator type of iterator
+ * @param first iterator of the first elem of the row
+ * @param last iterator of the end of the row
+ * @return the index of the row
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+template<class InputIterator>
+size_t vl_jagged<T, RowCapacity, Allocator>::add_row
+    (InputIterator first, InputIterator last)
+{
+  size_t row = add_row ();
+  if constexpr (std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<
+                                    InputIterator>::iterator_category>::value)
+    {
+      size_t count = std::distance (first, last);
+      if (count > RowCapacity)
+        grow_row (_rows[row], count);
+    }
+  (*this)[row].append (first, last);
+  return row;
+}
+
+/**
+ * adds empty rows, or removes rows from the end. the blocks of removed
+ * rows are holes until compact ()
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ * @param rows the new number of rows
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+void vl_jagged<T, RowCapacity, Allocator>::resize (size_t rows)
+{
+  if (rows <= size ())
+    {
+      for (size_t row = rows; row < size (); ++row)
+        _overflow_used -= _rows[row].cap;
+      _rows.resize (rows, row_info ());
+      _slots.resize_for_overwrite (rows * RowCapacity);
+      return;
+    }
+  reserve (rows);
+  while (size () < rows)
+    add_row ();
+}
+
+/**
+ * moves a row to a block of new_cap elems in the overflow array - push_back
+ * doubles the row, add_row gives it its size. the block of a row at the end
+ * of the array grows in place, otherwise a new one is added at the end and
+ * the old becomes a hole
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ * @param info the row
+ * @param new_cap the elems the row gets room for, more than it has
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+void vl_jagged<T, RowCapacity, Allocator>::grow_row
+    (row_info &info, size_t new_cap)
+{
+  if (new_cap > UINT32_MAX)
+    throw std::length_error ("Row Too Long");
+  if (info.cap != 0 && info.offset + info.cap == _overflow.size ())
+    { // the last block, it grows in place
+      _overflow.resize_for_overwrite (info.offset + new_cap);
+      _overflow_used += new_cap - info.cap;
+      info.cap = static_cast<uint32_t> (new_cap);
+      return;
+    }
+  size_t offset = _overflow.size ();
+  _overflow.resize_for_overwrite (offset + new_cap);
+  // after the resize - the old block may have moved with the array
+  std::memcpy (static_cast<void *> (_overflow.data () + offset),
+               static_cast<const void *> (row_data (info)),
+               info.size * sizeof (T));
+  _overflow_used += new_cap - info.cap;
+  info.offset = offset;
+  info.cap = static_cast<uint32_t> (new_cap);
+}
+
+/**
+ * packs the overflow array - the spilled rows that fit in their inline
+ * slots go back there, the others get blocks of their size in row order
+ * @tparam T the elems type
+ * @tparam RowCapacity the number of inline slots of every row
+ * @tparam Allocator where the arrays come from
+ */
+template<typename T, size_t RowCapacity, class Allocator>
+void vl_jagged<T, RowCapacity, Allocator>::compact ()
+{
+  size_t packed_size = 0;
+  for (const row_info &info : _rows)
+    if (info.cap != 0 && info.size > RowCapacity)
+      packed_size += info.size;
+  array packed (_overflow.get_allocator ());
+  packed.resize_for_overwrite (packed_size);
+  size_t offset = 0;
+  for (size_t row = 0; row < size (); ++row)
+    {
+      row_info &info = _rows[row];
+      if (info.cap == 0)
+        continue;
+      const T *old_data = row_data (info);
+      if (info.size <= RowCapacity)
+        {
+          info.offset = row * RowCapacity;
+          info.cap = 0;
+        }
+      else
+        {
+          info.offset = offset;
+          info.cap = info.size;
+          offset += info.size;
+        }
+      T *new_data = info.cap == 0 ? _slots.data () + info.offset
+                                  : packed.data () + info.offset;
+      std::memcpy (static_cast<void *> (new_data),
+                   static_cast<const void *> (old_data),
+                   info.size * sizeof (T));
+    }
+  _overflow = std::move (packed);
+  _overflow_used = packed_size;
+}
+
+#endif //_VL_JAGGED_H_
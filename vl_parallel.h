@@ -0,0 +1,478 @@
+#ifndef _VL_PARALLEL_H_
+#define _VL_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * parallel algorithms over random access ranges - vl_vector iterators, or
+ * any other. the work runs on a vl_thread_pool, split into chunks that idle
+ * threads steal from busy ones. ranges below vl_parallel_min elems run on
+ * the calling thread, so small (static) vectors never pay for the dispatch
+ */
+
+/** the smallest range that is split between threads */
+constexpr size_t vl_parallel_min = 1 << 14;
+/** the smallest chunk a thread works on */
+constexpr size_t vl_parallel_min_grain = 1 << 11;
+
+/**
+ * a work stealing thread pool. every worker has its own deque of tasks - it
+ * takes from the back of it, and idle threads steal from the front of the
+ * others, so the big halves of a split range go to thieves. a thread that
+ * waits for a parallel call works on tasks meanwhile, so calls may nest
+ * (a chunk may run a parallel call of its own)
+ */
+class vl_thread_pool {
+ public:
+  /** a pool of threads threads, counting the one that calls it */
+  explicit vl_thread_pool (size_t threads = default_threads ())
+      : _queues (threads > 0 ? threads : 1), _queued (0), _stop (false)
+  {
+    for (size_t i = 1; i < _queues.size (); ++i)
+      _workers.emplace_back ([this, i] { work (i); });
+  }
+  vl_thread_pool (const vl_thread_pool &) = delete;
+  vl_thread_pool &operator= (const vl_thread_pool &) = delete;
+  ~vl_thread_pool ()
+  {
+    {
+      std::lock_guard<std::mutex> lock (_sleep_mutex);
+      _stop = true;
+    }
+    _wake.notify_all ();
+    for (auto &worker : _workers)
+      worker.join ();
+  }
+
+  /** the pool the algorithms use by default, one thread per core */
+  static vl_thread_pool &global ()
+  {
+    static vl_thread_pool pool;
+    return pool;
+  }
+  /** the number of cores, at least 1 */
+  static size_t default_threads ()
+  {
+    size_t cores = std::thread::hardware_concurrency ();
+    return cores > 0 ? cores : 1;
+  }
+
+  /** the number of threads, counting the calling one */
+  size_t size () const
+  { return _queues.size (); }
+
+  /**
+   * the chunk size for count elems - count itself (no split) below
+   * vl_parallel_min, or a few chunks per thread so the stealing can even
+   * out chunks that take longer
+   */
+  size_t grain (size_t count) const
+  {
+    if (count < vl_parallel_min || size () == 1)
+      return count;
+    size_t chunk = (count + 4 * size () - 1) / (4 * size ());
+    return std::max (chunk, vl_parallel_min_grain);
+  }
+
+  /**
+   * calls func (first, last) on chunks of [0, count) of up to grain indexes,
+   * on all the threads, and returns when all of them are done. the first
+   * exception a chunk throws is thrown here, once all the chunks are done
+   * or skipped
+   * @tparam Func a callable that takes two size_t
+   * @param count the number of indexes
+   * @param grain the largest chunk
+   * @param func the callable
+   */
+  template<class Func>
+  void run (size_t count, size_t grain, Func func);
+
+ private:
+  struct call;
+  /** [first, last) of a call, split further before it runs */
+  struct task {
+    call *owner;
+    size_t first;
+    size_t last;
+  };
+  /** a parallel call - what to run, and how many indexes are left */
+  struct call {
+    void (*run_chunk) (call *, size_t, size_t);
+    size_t grain;
+    std::atomic<size_t> pending;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+  };
+  template<class Func>
+  struct typed_call : call {
+    Func *func;
+  };
+  struct queue {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  /** the queue of the current thread in this pool - 0 for outside threads */
+  size_t queue_index () const
+  { return current_pool () == this ? current_index () : 0; }
+  static const vl_thread_pool *&current_pool ()
+  {
+    static thread_local const vl_thread_pool *pool = nullptr;
+    return pool;
+  }
+  static size_t &current_index ()
+  {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  void push (const task &new_task)
+  {
+    queue &own = _queues[queue_index ()];
+    {
+      std::lock_guard<std::mutex> lock (own.mutex);
+      own.tasks.push_back (new_task);
+    }
+    _queued.fetch_add (1, std::memory_order_release);
+    if (!_workers.empty ())
+      {
+        std::lock_guard<std::mutex> lock (_sleep_mutex);
+        _wake.notify_one ();
+      }
+  }
+  /** a task from the back of the own queue, or stolen from another's front */
+  bool pop (task &out)
+  {
+    if (_queued.load (std::memory_order_acquire) == 0)
+      return false;
+    size_t own = queue_index ();
+    for (size_t i = 0; i < _queues.size (); ++i)
+      {
+        queue &from = _queues[(own + i) % _queues.size ()];
+        std::lock_guard<std::mutex> lock (from.mutex);
+        if (from.tasks.empty ())
+          continue;
+        if (i == 0)
+          {
+            out = from.tasks.back ();
+            from.tasks.pop_back ();
+          }
+        else
+          {
+            out = from.tasks.front ();
+            from.tasks.pop_front ();
+          }
+        _queued.fetch_sub (1, std::memory_order_relaxed);
+        return true;
+      }
+    return false;
+  }
+  /** splits the task down to the grain, queueing the far halves, runs it */
+  void execute (task current)
+  {
+    call *owner = current.owner;
+    while (current.last - current.first > owner->grain)
+      {
+        size_t mid = current.first + (current.last - current.first) / 2;
+        push (task {owner, mid, current.last});
+        current.last = mid;
+      }
+    if (!owner->failed.load (std::memory_order_relaxed))
+      {
+        try
+          {
+            owner->run_chunk (owner, current.first, current.last);
+          }
+        catch (...)
+          {
+            if (!owner->failed.exchange (true))
+              owner->error = std::current_exception ();
+          }
+      }
+    owner->pending.fetch_sub (current.last - current.first,
+                              std::memory_order_acq_rel);
+  }
+  /** a worker - runs tasks, sleeps when there are none */
+  void work (size_t index)
+  {
+    current_pool () = this;
+    current_index () = index;
+    task next;
+    for (;;)
+      {
+        if (pop (next))
+          {
+            execute (next);
+            continue;
+          }
+        std::unique_lock<std::mutex> lock (_sleep_mutex);
+        _wake.wait (lock, [this]
+        { return _stop || _queued.load (std::memory_order_acquire) > 0; });
+        if (_stop)
+          return;
+      }
+  }
+
+  std::vector<queue> _queues; // one per thread, 0 is for outside threads
+  std::vector<std::thread> _workers;
+  std::atomic<size_t> _queued; // the number of tasks in all the queues
+  std::mutex _sleep_mutex;
+  std::condition_variable _wake;
+  bool _stop;
+};
+
+/**
+ * runs func on chunks of [0, count), the calling thread works on them too
+ * @tparam Func a callable that takes two size_t
+ * @param count the number of indexes
+ * @param grain the largest chunk
+ * @param func the callable
+ */
+template<class Func>
+void vl_thread_pool::run (size_t count, size_t grain, Func func)
+{
+  if (count == 0)
+    return;
+  if (count <= grain || size () == 1)
+    {
+      func (size_t (0), count);
+      return;
+    }
+  typed_call<Func> this_call;
+  this_call.run_chunk = [] (call *owner, size_t first, size_t last)
+  { (*static_cast<typed_call<Func> *> (owner)->func) (first, last); };
+  this_call.grain = grain > 0 ? grain : 1;
+  this_call.pending.store (count, std::memory_order_relaxed);
+  this_call.failed.store (false, std::memory_order_relaxed);
+  this_call.func = &func;
+  execute (task {&this_call, 0, count});
+  // help with whatever is queued until the last chunk of this call is done
+  task next;
+  while (this_call.pending.load (std::memory_order_acquire) > 0)
+    {
+      if (pop (next))
+        execute (next);
+      else
+        std::this_thread::yield ();
+    }
+  if (this_call.error)
+    std::rethrow_exception (this_call.error);
+}
+
+/**
+ * calls func on every elem of [first, last)
+ * @tparam RandomIt random access iterator type
+ * @tparam Func a callable that takes an elem
+ * @param first the first elem
+ * @param last one past the last elem
+ * @param func the callable
+ * @param pool the threads to run on
+ */
+template<class RandomIt, class Func>
+void vl_parallel_for (RandomIt first, RandomIt last, Func func,
+                      vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last - first;
+  pool.run (count, pool.grain (count), [first, &func] (size_t from, size_t to)
+  {
+    for (RandomIt it = first + from, end = first + to; it != end; ++it)
+      func (*it);
+  });
+}
+
+/**
+ * writes op (elem) of every elem of [first, last) to out
+ * @tparam RandomIt random access iterator type
+ * @tparam OutIt random access iterator type
+ * @tparam UnaryOp a callable that takes an elem
+ * @param first the first elem
+ * @param last one past the last elem
+ * @param out where the results go
+ * @param op the callable
+ * @param pool the threads to run on
+ * @return one past the last result
+ */
+template<class RandomIt, class OutIt, class UnaryOp>
+OutIt vl_parallel_transform (RandomIt first, RandomIt last, OutIt out,
+                             UnaryOp op,
+                             vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last - first;
+  pool.run (count, pool.grain (count),
+            [first, out, &op] (size_t from, size_t to)
+            { std::transform (first + from, first + to, out + from, op); });
+  return out + count;
+}
+
+/**
+ * combines init and the elems of [first, last) with op. every chunk is
+ * reduced on its own, then the chunk results are combined in order, so op
+ * must be associative but need not be commutative
+ * @tparam RandomIt random access iterator type
+ * @tparam T the result type
+ * @tparam BinaryOp a callable that combines two T
+ * @param first the first elem
+ * @param last one past the last elem
+ * @param init the starting value
+ * @param op the callable
+ * @param pool the threads to run on
+ * @return the result
+ */
+template<class RandomIt, class T, class BinaryOp = std::plus<>>
+T vl_parallel_reduce (RandomIt first, RandomIt last, T init,
+                      BinaryOp op = BinaryOp (),
+                      vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last - first;
+  size_t grain = pool.grain (count);
+  if (count <= grain)
+    return std::accumulate (first, last, std::move (init), op);
+  size_t blocks = (count + grain - 1) / grain;
+  std::vector<T> partial (blocks, init);
+  pool.run (blocks, 1, [&] (size_t from, size_t to)
+  {
+    for (size_t block = from; block < to; ++block)
+      {
+        RandomIt it = first + block * grain;
+        RandomIt end = first + std::min (count, (block + 1) * grain);
+        T sum = *it;
+        for (++it; it != end; ++it)
+          sum = op (std::move (sum), *it);
+        partial[block] = std::move (sum);
+      }
+  });
+  T result = std::move (init);
+  for (T &sum : partial)
+    result = op (std::move (result), std::move (sum));
+  return result;
+}
+
+/**
+ * the first elem of [first, last) equal to value. chunks past one where it
+ * was found already are skipped
+ * @tparam RandomIt random access iterator type
+ * @tparam T the value type
+ * @param first the first elem
+ * @param last one past the last elem
+ * @param value the value to look for
+ * @param pool the threads to run on
+ * @return the first equal elem, or last
+ */
+template<class RandomIt, class T>
+RandomIt vl_parallel_find (RandomIt first, RandomIt last, const T &value,
+                           vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last - first;
+  size_t grain = pool.grain (count);
+  if (count <= grain)
+    return std::find (first, last, value);
+  size_t blocks = (count + grain - 1) / grain;
+  std::atomic<size_t> found (count);
+  pool.run (blocks, 1, [&] (size_t from, size_t to)
+  {
+    for (size_t block = from; block < to; ++block)
+      {
+        size_t begin = block * grain;
+        if (begin >= found.load (std::memory_order_relaxed))
+          return;
+        RandomIt end = first + std::min (count, begin + grain);
+        RandomIt it = std::find (first + begin, end, value);
+        if (it == end)
+          continue;
+        size_t index = it - first;
+        size_t best = found.load (std::memory_order_relaxed);
+        while (index < best
+               && !found.compare_exchange_weak (best, index,
+                                                std::memory_order_relaxed))
+          {}
+        return;
+      }
+  });
+  return first + found.load ();
+}
+
+/**
+ * tells if [first1, last1) and the range from first2 on are equal, elem by
+ * elem. the chunks stop once one of them finds a difference
+ * @tparam RandomIt1 random access iterator type
+ * @tparam RandomIt2 random access iterator type
+ * @param first1 the first elem of the first range
+ * @param last1 one past the last elem of the first range
+ * @param first2 the first elem of the second range
+ * @param pool the threads to run on
+ * @return true if the ranges are equal
+ */
+template<class RandomIt1, class RandomIt2>
+bool vl_parallel_equal (RandomIt1 first1, RandomIt1 last1, RandomIt2 first2,
+                        vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last1 - first1;
+  std::atomic<bool> differ (false);
+  pool.run (count, pool.grain (count), [&] (size_t from, size_t to)
+  {
+    if (!differ.load (std::memory_order_relaxed)
+        && !std::equal (first1 + from, first1 + to, first2 + from))
+      differ.store (true, std::memory_order_relaxed);
+  });
+  return !differ.load ();
+}
+
+/**
+ * sorts [first, last) - the chunks are sorted in parallel, then merged in
+ * pairs, every round of merges in parallel
+ * @tparam RandomIt random access iterator type
+ * @tparam Compare a callable that compares two elems
+ * @param first the first elem
+ * @param last one past the last elem
+ * @param comp the comparison
+ * @param pool the threads to run on
+ */
+template<class RandomIt, class Compare = std::less<>>
+void vl_parallel_sort (RandomIt first, RandomIt last,
+                       Compare comp = Compare (),
+                       vl_thread_pool &pool = vl_thread_pool::global ())
+{
+  size_t count = last - first;
+  if (count < vl_parallel_min || pool.size () == 1)
+    {
+      std::sort (first, last, comp);
+      return;
+    }
+  // a power of two of chunks, a few per thread
+  size_t blocks = 1;
+  while (blocks < 2 * pool.size ())
+    blocks <<= 1;
+  size_t block_size = (count + blocks - 1) / blocks;
+  auto bound = [&] (size_t block)
+  { return first + std::min (count, block * block_size); };
+  pool.run (blocks, 1, [&] (size_t from, size_t to)
+  {
+    for (size_t block = from; block < to; ++block)
+      std::sort (bound (block), bound (block + 1), comp);
+  });
+  for (size_t width = 1; width < blocks; width *= 2)
+    pool.run (blocks / (2 * width), 1, [&] (size_t from, size_t to)
+    {
+      for (size_t pair = from; pair < to; ++pair)
+        {
+          size_t left = pair * 2 * width;
+          std::inplace_merge (bound (left), bound (left + width),
+                              bound (left + 2 * width), comp);
+        }
+    });
+}
+
+#endif //_VL_PARALLEL_H_
@@ -0,0 +1,362 @@
+#ifndef _VL_SEARCH_H_
+#define _VL_SEARCH_H_
+
+#include "vl_simd.h"
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+/**
+ * substring search over char arrays, used by vl_string. needles of up to
+ * vl_short_needle chars are found by filtering the positions where both the
+ * first and the last char of the needle match, 16 / 32 positions at a time
+ * (SSE2 / AVX2), and checking only those with memcmp. longer needles use
+ * Boyer-Moore-Horspool, which skips up to the needle length per step. single
+ * chars go to memchr
+ */
+
+/** returned when nothing is found */
+constexpr size_t vl_npos = static_cast<size_t> (-1);
+/** the longest needle that is searched with the first / last char filter */
+constexpr size_t vl_short_needle = 32;
+
+/** first / last char filter without simd - memchr for the first char */
+inline size_t vl_scalar_find_str (const char *hay, size_t n,
+                                  const char *needle, size_t m, size_t from)
+{
+  const char *last = hay + n - m; // the last position the needle can start
+  const char *cur = hay + from;
+  while (cur <= last)
+    {
+      cur = static_cast<const char *> (
+          std::memchr (cur, needle[0], last - cur + 1));
+      if (cur == nullptr)
+        return vl_npos;
+      if (cur[m - 1] == needle[m - 1] && std::memcmp (cur, needle, m) == 0)
+        return cur - hay;
+      ++cur;
+    }
+  return vl_npos;
+}
+
+#ifdef VL_SIMD_X86
+
+/** the first / last char filter, 16 positions at a time. m >= 2 */
+inline size_t vl_sse2_find_str (const char *hay, size_t n,
+                                const char *needle, size_t m, size_t from)
+{
+  const __m128i first = _mm_set1_epi8 (needle[0]);
+  const __m128i last = _mm_set1_epi8 (needle[m - 1]);
+  size_t i = from;
+  for (; i + m - 1 + 16 <= n; i += 16)
+    {
+      __m128i block_first =
+          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (hay + i));
+      __m128i block_last = _mm_loadu_si128 (
+          reinterpret_cast<const __m128i *> (hay + i + m - 1));
+      unsigned mask = _mm_movemask_epi8 (
+          _mm_and_si128 (_mm_cmpeq_epi8 (first, block_first),
+                         _mm_cmpeq_epi8 (last, block_last)));
+      while (mask != 0)
+        {
+          unsigned bit = __builtin_ctz (mask);
+          if (std::memcmp (hay + i + bit + 1, needle + 1, m - 2) == 0)
+            return i + bit;
+          mask &= mask - 1;
+        }
+    }
+  return i + m <= n ? vl_scalar_find_str (hay, n, needle, m, i) : vl_npos;
+}
+/** the first / last char filter, 32 positions at a time. m >= 2 */
+__attribute__ ((target ("avx2")))
+inline size_t vl_avx2_find_str (const char *hay, size_t n,
+                                const char *needle, size_t m, size_t from)
+{
+  const __m256i first = _mm256_set1_epi8 (needle[0]);
+  const __m256i last = _mm256_set1_epi8 (needle[m - 1]);
+  size_t i = from;
+  for (; i + m - 1 + 32 <= n; i += 32)
+    {
+      __m256i block_first =
+          _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (hay + i));
+      __m256i block_last = _mm256_loadu_si256 (
+          reinterpret_cast<const __m256i *> (hay + i + m - 1));
+      unsigned mask = static_cast<unsigned> (_mm256_movemask_epi8 (
+          _mm256_and_si256 (_mm256_cmpeq_epi8 (first, block_first),
+                            _mm256_cmpeq_epi8 (last, block_last))));
+      while (mask != 0)
+        {
+          unsigned bit = __builtin_ctz (mask);
+          if (std::memcmp (hay + i + bit + 1, needle + 1, m - 2) == 0)
+            return i + bit;
+          mask &= mask - 1;
+        }
+    }
+  return i + m <= n ? vl_sse2_find_str (hay, n, needle, m, i) : vl_npos;
+}
+
+#endif //VL_SIMD_X86
+
+/** the first / last char filter, on the best instructions the cpu has */
+inline size_t vl_filter_find_str (const char *hay, size_t n,
+                                  const char *needle, size_t m, size_t from)
+{
+#ifdef VL_SIMD_X86
+  if (vl_cpu_has_avx2 ())
+    return vl_avx2_find_str (hay, n, needle, m, from);
+  return vl_sse2_find_str (hay, n, needle, m, from);
+#else
+  return vl_scalar_find_str (hay, n, needle, m, from);
+#endif
+}
+
+/** fills the Boyer-Moore-Horspool table - how far a mismatch can shift */
+inline void vl_horspool_table (const char *needle, size_t m, size_t *skip)
+{
+  for (size_t c = 0; c < 256; ++c)
+    skip[c] = m;
+  for (size_t i = 0; i + 1 < m; ++i)
+    skip[static_cast<unsigned char> (needle[i])] = m - 1 - i;
+}
+/** Boyer-Moore-Horspool search with a table from vl_horspool_table */
+inline size_t vl_horspool_find (const char *hay, size_t n, const char *needle,
+                                size_t m, size_t from, const size_t *skip)
+{
+  const char needle_last = needle[m - 1];
+  for (size_t i = from; i + m <= n;)
+    {
+      char c = hay[i + m - 1];
+      if (c == needle_last && std::memcmp (hay + i, needle, m - 1) == 0)
+        return i;
+      i += skip[static_cast<unsigned char> (c)];
+    }
+  return vl_npos;
+}
+
+/**
+ * the first position, from from on, where needle starts in hay
+ * @param hay the chars to search in
+ * @param n the number of chars in hay
+ * @param needle the chars to search for
+ * @param m the number of chars in needle
+ * @param from the first position to check
+ * @return the position, or vl_npos if there is none
+ */
+inline size_t vl_find (const char *hay, size_t n, const char *needle,
+                       size_t m, size_t from = 0)
+{
+  if (from > n || m > n - from)
+    return vl_npos;
+  if (m == 0)
+    return from;
+  if (m == 1)
+    {
+      const void *found = std::memchr (hay + from, needle[0], n - from);
+      return found ? static_cast<const char *> (found) - hay : vl_npos;
+    }
+  if (m <= vl_short_needle)
+    return vl_filter_find_str (hay, n, needle, m, from);
+  size_t skip[256];
+  vl_horspool_table (needle, m, skip);
+  return vl_horspool_find (hay, n, needle, m, from, skip);
+}
+/**
+ * the last position, up to from, where needle starts in hay
+ * @param hay the chars to search in
+ * @param n the number of chars in hay
+ * @param needle the chars to search for
+ * @param m the number of chars in needle
+ * @param from the last position to check
+ * @return the position, or vl_npos if there is none
+ */
+inline size_t vl_rfind (const char *hay, size_t n, const char *needle,
+                        size_t m, size_t from = vl_npos)
+{
+  if (m > n)
+    return vl_npos;
+  size_t i = from < n - m ? from : n - m;
+  if (m == 0)
+    return i;
+  for (;; --i)
+    {
+      if (hay[i] == needle[0] && hay[i + m - 1] == needle[m - 1]
+          && std::memcmp (hay + i, needle, m) == 0)
+        return i;
+      if (i == 0)
+        return vl_npos;
+    }
+}
+/**
+ * the first position, from from on, of a char that is one of set
+ * @param hay the chars to search in
+ * @param n the number of chars in hay
+ * @param set the chars to look for
+ * @param k the number of chars in set
+ * @param from the first position to check
+ * @return the position, or vl_npos if there is none
+ */
+inline size_t vl_find_first_of (const char *hay, size_t n, const char *set,
+                                size_t k, size_t from = 0)
+{
+  if (from >= n || k == 0)
+    return vl_npos;
+  if (k == 1)
+    return vl_find (hay, n, set, 1, from);
+  bool in_set[256] = {};
+  for (size_t i = 0; i < k; ++i)
+    in_set[static_cast<unsigned char> (set[i])] = true;
+  for (size_t i = from; i < n; ++i)
+    if (in_set[static_cast<unsigned char> (hay[i])])
+      return i;
+  return vl_npos;
+}
+
+/**
+ * a needle prepared once for many searches - it keeps its own copy of the
+ * needle, and the Boyer-Moore-Horspool table when the needle is long
+ */
+class vl_string_searcher {
+ public:
+  vl_string_searcher (const char *needle, size_t len) : _needle (needle, len)
+  {
+    if (len > vl_short_needle)
+      vl_horspool_table (_needle.data (), len, _skip);
+  }
+  explicit vl_string_searcher (const char *needle)
+      : vl_string_searcher (needle, std::strlen (needle))
+  {}
+
+  /**
+   * the first position, from from on, where the needle starts in hay
+   * @return the position, or vl_npos if there is none
+   */
+  size_t find (const char *hay, size_t n, size_t from = 0) const
+  {
+    size_t m = _needle.size ();
+    if (m <= vl_short_needle)
+      return vl_find (hay, n, _needle.data (), m, from);
+    if (from > n || m > n - from)
+      return vl_npos;
+    return vl_horspool_find (hay, n, _needle.data (), m, from, _skip);
+  }
+  /** the needle */
+  const char *needle () const
+  { return _needle.data (); }
+  size_t size () const
+  { return _needle.size (); }
+
+ private:
+  std::string _needle;
+  size_t _skip[256];
+};
+
+/**
+ * the fields of a text between delimiters, as views into the text - no
+ * field is copied and nothing is allocated. empty fields are kept, so
+ * "a,,b" split by ',' gives "a", "" and "b". the text must outlive the
+ * fields, like every std::string_view into it
+ */
+class vl_split_view {
+ public:
+  /** goes over the fields, in order */
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::string_view value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::string_view *pointer;
+    typedef const std::string_view &reference;
+
+    /** the end iterator */
+    iterator () : _split (nullptr), _pos (0), _end (0)
+    {}
+    /** the field that starts at pos */
+    iterator (const vl_split_view *split, size_t pos)
+        : _split (split), _pos (pos)
+    { find_end (); }
+
+    reference operator* () const
+    { return _field; }
+    pointer operator-> () const
+    { return &_field; }
+    iterator &operator++ ()
+    {
+      if (_end == _split->_text.size ())
+        _split = nullptr; // that was the last field
+      else
+        {
+          _pos = _end + _split->delim ().size ();
+          find_end ();
+        }
+      return *this;
+    }
+    iterator operator++ (int)
+    {
+      iterator old = *this;
+      ++*this;
+      return old;
+    }
+    bool operator== (const iterator &other) const
+    {
+      return _split == other._split
+             && (_split == nullptr || _pos == other._pos);
+    }
+    bool operator!= (const iterator &other) const
+    { return !(*this == other); }
+
+   private:
+    /** finds the delimiter that ends the field at _pos */
+    void find_end ()
+    {
+      std::string_view text = _split->_text;
+      std::string_view delim = _split->delim ();
+      _end = delim.empty () ? vl_npos : vl_find (text.data (), text.size (),
+                                                  delim.data (), delim.size (),
+                                                  _pos);
+      if (_end == vl_npos)
+        _end = text.size ();
+      _field = text.substr (_pos, _end - _pos);
+    }
+
+    const vl_split_view *_split; // nullptr past the last field
+    size_t _pos; // where the field starts
+    size_t _end; // where the field ends
+    std::string_view _field;
+  };
+
+  /** the fields of text between delim chars */
+  vl_split_view (std::string_view text, char delim)
+      : _text (text), _delim (), _delim_char (delim)
+  {}
+  /** the fields of text between delim strings, an empty delim gives the text */
+  vl_split_view (std::string_view text, std::string_view delim)
+      : _text (text), _delim (delim.empty () ? std::string_view ("") : delim),
+        _delim_char ('\0')
+  {}
+
+  /** the iterators are valid as long as this view is */
+  iterator begin () const
+  { return iterator (this, 0); }
+  iterator end () const
+  { return iterator (); }
+
+ private:
+  /** the delimiter - a char is kept here, so copies of the view stay valid */
+  std::string_view delim () const
+  { return _delim.data () != nullptr ? _delim
+                                     : std::string_view (&_delim_char, 1); }
+
+  std::string_view _text;
+  std::string_view _delim; // no data when the delimiter is _delim_char
+  char _delim_char;
+};
+
+/** the fields of text between delimiters, see vl_split_view */
+inline vl_split_view vl_split (std::string_view text, char delim)
+{ return vl_split_view (text, delim); }
+inline vl_split_view vl_split (std::string_view text, std::string_view delim)
+{ return vl_split_view (text, delim); }
+
+#endif //_VL_SEARCH_H_
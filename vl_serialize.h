@@ -0,0 +1,528 @@
+#ifndef _VL_SERIALIZE_H_
+#define _VL_SERIALIZE_H_
+
+#include "vl_span.h"
+#include "vl_string.h"
+#include "vl_vector.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+
+/**
+ * a compact binary format for vl_vector / vl_string, written with one writev
+ * per container and read back with one read per container, or mapped and
+ * used in place. every container is a record:
+ *   vl_blob_header (16 bytes) - magic, kind, elem size, count
+ *   vector of T   - count * sizeof (T) bytes, T as it is in memory
+ *   string        - count chars and the '\0'
+ *   strings       - count + 1 uint64_t offsets, then the chars of every
+ *                   string with its '\0', string i is [offset i, offset i+1)
+ * padded to vl_blob_align bytes, so the payload of a mapped record is
+ * aligned for any T. the numbers are in the machine's byte order, the files
+ * are for the machine (or ones like it) that wrote them
+ */
+
+/** the first bytes of every record */
+struct vl_blob_header {
+  uint32_t magic;
+  uint16_t kind;
+  uint16_t elem_size;
+  uint64_t count;
+};
+
+constexpr uint32_t vl_blob_magic = 0x42564c56; // "VLVB"
+constexpr size_t vl_blob_align = 16;
+/** the kinds of records */
+constexpr uint16_t vl_blob_vector = 1;
+constexpr uint16_t vl_blob_string = 2;
+constexpr uint16_t vl_blob_strings = 3;
+
+/** the padding after a record of bytes bytes */
+inline size_t vl_blob_padding (size_t bytes)
+{ return (vl_blob_align - bytes % vl_blob_align) % vl_blob_align; }
+
+/** checks a header, throws if it is not the expected record */
+inline void vl_check_header (const vl_blob_header &header, uint16_t kind,
+                             size_t elem_size)
+{
+  if (header.magic != vl_blob_magic)
+    throw std::runtime_error ("Not a vl_vector record");
+  if (header.kind != kind || header.elem_size != elem_size)
+    throw std::runtime_error ("Unexpected vl_vector record");
+}
+
+/**
+ * checks the count + 1 offsets of a strings record - they start at 0 and
+ * grow by at least the terminator of every string, so the last one is the
+ * size of the chars. throws if they don't
+ */
+inline void vl_check_offsets (const uint64_t *offsets, size_t count)
+{
+  if (offsets[0] != 0)
+    throw std::runtime_error ("Corrupt vl_vector record");
+  for (size_t i = 0; i < count; ++i)
+    if (offsets[i + 1] <= offsets[i])
+      throw std::runtime_error ("Corrupt vl_vector record");
+}
+
+/**
+ * writes records to a file descriptor, one writev per container (a vector
+ * of more than IOV_MAX / 2 strings takes one writev per IOV_MAX / 2 of them)
+ */
+class vl_blob_writer {
+ public:
+  /** writes to fd, which stays open */
+  explicit vl_blob_writer (int fd) : _fd (fd), _owned (false)
+  {}
+  /** writes to a new (or emptied) file */
+  explicit vl_blob_writer (const char *path)
+      : _fd (::open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644)), _owned (true)
+  {
+    if (_fd < 0)
+      throw std::system_error (errno, std::generic_category (), path);
+  }
+  vl_blob_writer (const vl_blob_writer &) = delete;
+  vl_blob_writer &operator= (const vl_blob_writer &) = delete;
+  ~vl_blob_writer ()
+  {
+    if (_owned)
+      ::close (_fd);
+  }
+
+  /** writes a vector of trivially copyable elems */
+  template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+      class GrowthPolicy, class Allocator>
+  void write (const vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                              Allocator> &vec)
+  {
+    static_assert (std::is_trivially_copyable<T>::value,
+                   "only vectors of trivially copyable elems are written raw");
+    static_assert (sizeof (T) <= UINT16_MAX, "the elems are too big to write");
+    size_t bytes = vec.size () * sizeof (T);
+    vl_blob_header header {vl_blob_magic, vl_blob_vector, sizeof (T),
+                           vec.size ()};
+    iovec iov[3] = {{&header, sizeof (header)},
+                    {const_cast<T *> (vec.data ()), bytes},
+                    {const_cast<char *> (_zeros), vl_blob_padding (bytes)}};
+    write_all (iov, 3);
+  }
+  /**
+   * writes a string. the terminator comes from _zeros, c_str () would
+   * write to the string, and it may be read by other threads
+   */
+  template<size_t StaticCapacity, class Allocator>
+  void write (const vl_string<StaticCapacity, Allocator> &str)
+  {
+    size_t bytes = str.size () + 1;
+    vl_blob_header header {vl_blob_magic, vl_blob_string, 1, str.size ()};
+    iovec iov[4] = {{&header, sizeof (header)},
+                    {const_cast<char *> (str.data ()), str.size ()},
+                    {const_cast<char *> (_zeros), 1},
+                    {const_cast<char *> (_zeros), vl_blob_padding (bytes)}};
+    write_all (iov, 4);
+  }
+  /** writes a vector of strings - the offsets, then the chars of them all */
+  template<size_t StringCapacity, class StringAllocator,
+      size_t StaticCapacity, class ShrinkPolicy, class GrowthPolicy,
+      class Allocator>
+  void write (const vl_vector<vl_string<StringCapacity, StringAllocator>,
+                              StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                              Allocator> &strs);
+
+ private:
+  /** writes all of iov, going on after partial writes */
+  void write_all (iovec *iov, int count)
+  {
+    while (count > 0)
+      {
+        ssize_t written = ::writev (_fd, iov, std::min (count, IOV_MAX));
+        if (written < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            throw std::system_error (errno, std::generic_category (),
+                                     "vl_blob_writer");
+          }
+        size_t left = static_cast<size_t> (written);
+        while (count > 0 && left >= iov->iov_len)
+          {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+          }
+        if (count > 0)
+          {
+            iov->iov_base = static_cast<char *> (iov->iov_base) + left;
+            iov->iov_len -= left;
+          }
+      }
+  }
+
+  int _fd;
+  bool _owned;
+  static constexpr char _zeros[vl_blob_align] = {};
+};
+
+/**
+ * writes a vector of strings - one writev for the header, the offsets and
+ * the chars of every string, straight from the strings
+ * @tparam StringCapacity the static capacity of the strings
+ * @tparam StringAllocator where the heap arrays of the strings come from
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array of the vector comes from
+ * @param strs the strings
+ */
+template<size_t StringCapacity, class StringAllocator,
+    size_t StaticCapacity, class ShrinkPolicy, class GrowthPolicy,
+    class Allocator>
+void vl_blob_writer::write (const vl_vector<vl_string<StringCapacity,
+                                                      StringAllocator>,
+                                            StaticCapacity, ShrinkPolicy,
+                                            GrowthPolicy, Allocator> &strs)
+{
+  size_t count = strs.size ();
+  vl_vector<uint64_t> offsets;
+  offsets.resize_for_overwrite (count + 1);
+  uint64_t offset = 0;
+  for (size_t i = 0; i < count; ++i)
+    {
+      offsets[i] = offset;
+      offset += strs[i].size () + 1;
+    }
+  offsets[count] = offset;
+  size_t bytes = offsets.size () * sizeof (uint64_t) + offset;
+  vl_blob_header header {vl_blob_magic, vl_blob_strings, 1, count};
+  // every string is its chars and a terminator from _zeros - c_str () would
+  // write to the strings
+  vl_vector<iovec> iov;
+  iov.resize_for_overwrite (2 * count + 3);
+  iov[0] = {&header, sizeof (header)};
+  iov[1] = {offsets.data (), offsets.size () * sizeof (uint64_t)};
+  for (size_t i = 0; i < count; ++i)
+    {
+      iov[2 * i + 2] = {const_cast<char *> (strs[i].data ()), strs[i].size ()};
+      iov[2 * i + 3] = {const_cast<char *> (_zeros), 1};
+    }
+  iov[2 * count + 2] = {const_cast<char *> (_zeros), vl_blob_padding (bytes)};
+  write_all (iov.data (), static_cast<int> (iov.size ()));
+}
+
+/**
+ * reads records from a file descriptor, straight into the containers - a
+ * header read, then one readv for the payload and its padding
+ */
+class vl_blob_reader {
+ public:
+  /** reads from fd, which stays open */
+  explicit vl_blob_reader (int fd) : _fd (fd), _owned (false)
+  {}
+  /** reads from a file */
+  explicit vl_blob_reader (const char *path)
+      : _fd (::open (path, O_RDONLY)), _owned (true)
+  {
+    if (_fd < 0)
+      throw std::system_error (errno, std::generic_category (), path);
+  }
+  vl_blob_reader (const vl_blob_reader &) = delete;
+  vl_blob_reader &operator= (const vl_blob_reader &) = delete;
+  ~vl_blob_reader ()
+  {
+    if (_owned)
+      ::close (_fd);
+  }
+
+  /** replaces the elems of vec with the next record */
+  template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+      class GrowthPolicy, class Allocator>
+  void read (vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                       Allocator> &vec)
+  {
+    static_assert (std::is_trivially_copyable<T>::value,
+                   "only vectors of trivially copyable elems are read raw");
+    vl_blob_header header = read_header (vl_blob_vector, sizeof (T));
+    check_left (header.count * sizeof (T));
+    vec.resize_for_overwrite (header.count);
+    read_payload (vec.data (), header.count * sizeof (T));
+  }
+  /** replaces the chars of str with the next record */
+  template<size_t StaticCapacity, class Allocator>
+  void read (vl_string<StaticCapacity, Allocator> &str)
+  {
+    vl_blob_header header = read_header (vl_blob_string, 1);
+    check_left (header.count + 1);
+    str.resize_for_overwrite (header.count);
+    // the terminator of the record is read with the padding
+    char padding[vl_blob_align];
+    iovec iov[2] = {{str.data (), header.count},
+                    {padding, 1 + vl_blob_padding (header.count + 1)}};
+    read_all (iov, 2);
+  }
+  /** replaces the strings of strs with the next record */
+  template<size_t StringCapacity, class StringAllocator,
+      size_t StaticCapacity, class ShrinkPolicy, class GrowthPolicy,
+      class Allocator>
+  void read (vl_vector<vl_string<StringCapacity, StringAllocator>,
+                       StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                       Allocator> &strs)
+  {
+    vl_blob_header header = read_header (vl_blob_strings, 1);
+    if (header.count >= SIZE_MAX / sizeof (uint64_t) - 1)
+      throw std::runtime_error ("Corrupt vl_vector record");
+    check_left ((header.count + 1) * sizeof (uint64_t));
+    vl_vector<uint64_t> offsets;
+    offsets.resize_for_overwrite (header.count + 1);
+    read_exactly (offsets.data (), offsets.size () * sizeof (uint64_t));
+    vl_check_offsets (offsets.data (), header.count);
+    check_left (offsets[header.count]);
+    vl_vector<char> chars;
+    chars.resize_for_overwrite (offsets[header.count]);
+    read_payload (chars.data (), chars.size (),
+                  offsets.size () * sizeof (uint64_t));
+    strs.clear ();
+    strs.reserve (header.count);
+    for (size_t i = 0; i < header.count; ++i)
+      strs.emplace_back (chars.data () + offsets[i],
+                         offsets[i + 1] - offsets[i] - 1);
+  }
+
+ private:
+  vl_blob_header read_header (uint16_t kind, size_t elem_size)
+  {
+    vl_blob_header header;
+    read_exactly (&header, sizeof (header));
+    vl_check_header (header, kind, elem_size);
+    // the payload size (and the string terminator) must not overflow
+    if (header.count > (SIZE_MAX - vl_blob_align) / elem_size)
+      throw std::runtime_error ("Corrupt vl_vector record");
+    return header;
+  }
+  /**
+   * throws if a regular file has less than bytes bytes left - a corrupt
+   * count must not allocate more than the file holds. pipes and sockets
+   * can't tell, their reads throw when they end
+   */
+  void check_left (uint64_t bytes)
+  {
+    struct stat info;
+    if (::fstat (_fd, &info) < 0 || !S_ISREG (info.st_mode))
+      return;
+    off_t pos = ::lseek (_fd, 0, SEEK_CUR);
+    if (pos >= 0 && bytes > static_cast<uint64_t> (info.st_size - pos))
+      throw std::runtime_error ("Truncated vl_vector record");
+  }
+  /**
+   * reads bytes bytes to dest, and the padding after them. before is the
+   * size of what was read of the payload so far
+   */
+  void read_payload (void *dest, size_t bytes, size_t before = 0)
+  {
+    char padding[vl_blob_align];
+    iovec iov[2] = {{dest, bytes},
+                    {padding, vl_blob_padding (before + bytes)}};
+    read_all (iov, 2);
+  }
+  void read_exactly (void *dest, size_t bytes)
+  {
+    iovec iov = {dest, bytes};
+    read_all (&iov, 1);
+  }
+  /** fills all of iov, throws if the file ends first */
+  void read_all (iovec *iov, int count)
+  {
+    while (count > 0)
+      {
+        if (iov->iov_len == 0)
+          {
+            ++iov;
+            --count;
+            continue;
+          }
+        ssize_t got = ::readv (_fd, iov, count);
+        if (got < 0)
+          {
+            if (errno == EINTR)
+              continue;
+            throw std::system_error (errno, std::generic_category (),
+                                     "vl_blob_reader");
+          }
+        if (got == 0)
+          throw std::runtime_error ("Truncated vl_vector record");
+        size_t left = static_cast<size_t> (got);
+        while (count > 0 && left >= iov->iov_len)
+          {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+          }
+        if (count > 0)
+          {
+            iov->iov_base = static_cast<char *> (iov->iov_base) + left;
+            iov->iov_len -= left;
+          }
+      }
+  }
+
+  int _fd;
+  bool _owned;
+};
+
+/** the strings of a mapped strings record, as views into the mapping */
+class vl_mapped_strings {
+ public:
+  vl_mapped_strings (const uint64_t *offsets, const char *chars, size_t count)
+      : _offsets (offsets), _chars (chars), _count (count)
+  {}
+
+  size_t size () const
+  { return _count; }
+  bool empty () const
+  { return _count == 0; }
+  /** string index, without its terminator */
+  std::string_view operator[] (size_t index) const
+  {
+    return std::string_view (_chars + _offsets[index],
+                             _offsets[index + 1] - _offsets[index] - 1);
+  }
+  /** string index, null terminated */
+  const char *c_str (size_t index) const
+  { return _chars + _offsets[index]; }
+
+ private:
+  const uint64_t *_offsets;
+  const char *_chars;
+  size_t _count;
+};
+
+/**
+ * a file of records mapped read only - the records are read in order as
+ * views into the mapping, with no copy and no parsing. the views are valid
+ * as long as this object is
+ */
+class vl_mapped_blobs {
+ public:
+  explicit vl_mapped_blobs (const char *path) : _base (nullptr), _size (0),
+                                                _pos (0)
+  {
+    int fd = ::open (path, O_RDONLY);
+    if (fd < 0)
+      throw std::system_error (errno, std::generic_category (), path);
+    struct stat info;
+    if (::fstat (fd, &info) < 0)
+      {
+        int error = errno;
+        ::close (fd);
+        throw std::system_error (error, std::generic_category (), path);
+      }
+    _size = static_cast<size_t> (info.st_size);
+    if (_size > 0)
+      {
+        void *mapped = ::mmap (nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+          {
+            int error = errno;
+            ::close (fd);
+            throw std::system_error (error, std::generic_category (), path);
+          }
+        _base = static_cast<const char *> (mapped);
+      }
+    ::close (fd);
+  }
+  vl_mapped_blobs (const vl_mapped_blobs &) = delete;
+  vl_mapped_blobs &operator= (const vl_mapped_blobs &) = delete;
+  ~vl_mapped_blobs ()
+  {
+    if (_base != nullptr)
+      ::munmap (const_cast<char *> (_base), _size);
+  }
+
+  /** tells if all the records were read */
+  bool at_end () const
+  { return _pos == _size; }
+
+  /** the next record, a vector of T */
+  template<typename T>
+  vl_span<const T> next_vector ()
+  {
+    static_assert (std::is_trivially_copyable<T>::value,
+                   "only vectors of trivially copyable elems are mapped");
+    static_assert (alignof (T) <= vl_blob_align,
+                   "the elems must fit the record alignment");
+    vl_blob_header header = next_header (vl_blob_vector, sizeof (T));
+    if (header.count > (_size - _pos) / sizeof (T))
+      throw std::runtime_error ("Truncated vl_vector record");
+    const char *payload = take (header.count * sizeof (T));
+    return vl_span<const T> (reinterpret_cast<const T *> (payload),
+                             header.count);
+  }
+  /** the next record, a string */
+  std::string_view next_string ()
+  {
+    vl_blob_header header = next_header (vl_blob_string, 1);
+    if (header.count >= _size - _pos)
+      throw std::runtime_error ("Truncated vl_vector record");
+    return std::string_view (take (header.count + 1), header.count);
+  }
+  /** the next record, a vector of strings */
+  vl_mapped_strings next_strings ()
+  {
+    vl_blob_header header = next_header (vl_blob_strings, 1);
+    if (header.count >= (_size - _pos) / sizeof (uint64_t))
+      throw std::runtime_error ("Truncated vl_vector record");
+    size_t offsets_bytes = (header.count + 1) * sizeof (uint64_t);
+    const uint64_t *offsets = reinterpret_cast<const uint64_t *> (_base
+                                                                  + _pos);
+    // checked once here, operator[] and c_str trust them
+    vl_check_offsets (offsets, header.count);
+    if (offsets[header.count] > _size - _pos - offsets_bytes)
+      throw std::runtime_error ("Truncated vl_vector record");
+    const char *payload = take (offsets_bytes + offsets[header.count]);
+    const char *chars = payload + offsets_bytes;
+    for (size_t i = 0; i < header.count; ++i)
+      if (chars[offsets[i + 1] - 1] != '\0')
+        throw std::runtime_error ("Corrupt vl_vector record");
+    return vl_mapped_strings (offsets, chars, header.count);
+  }
+
+ private:
+  vl_blob_header next_header (uint16_t kind, size_t elem_size)
+  {
+    vl_blob_header header;
+    std::memcpy (&header, take_raw (sizeof (header)), sizeof (header));
+    vl_check_header (header, kind, elem_size);
+    return header;
+  }
+  /** the payload of bytes bytes at the read position, skipping its padding */
+  const char *take (size_t bytes)
+  {
+    const char *payload = take_raw (bytes);
+    take_raw (std::min (vl_blob_padding (bytes), _size - _pos));
+    return payload;
+  }
+  const char *take_raw (size_t bytes)
+  {
+    if (bytes > _size - _pos)
+      throw std::runtime_error ("Truncated vl_vector record");
+    const char *at = _base + _pos;
+    _pos += bytes;
+    return at;
+  }
+
+  const char *_base;
+  size_t _size;
+  size_t _pos;
+};
+
+#endif //_VL_SERIALIZE_H_
@@ -0,0 +1,272 @@
+#ifndef _VL_SIMD_H_
+#define _VL_SIMD_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) \
+    || (defined(__i386__) && defined(__SSE2__)))
+#define VL_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * search kernels for arrays of arithmetic elems - find the first elem equal
+ * to a value, or count the elems equal to it. on x86 they compare 16 (SSE2)
+ * or 32 (AVX2, picked at runtime if the cpu has it) bytes at a time, and
+ * fall back to plain loops anywhere else. floats compare like operator==
+ * does (0.0 equals -0.0, NaN equals nothing)
+ */
+
+/**
+ * tells if the kernels support T
+ * @tparam T the elems type
+ */
+template<typename T>
+struct vl_simd_supported
+    : std::integral_constant<bool, std::is_arithmetic<T>::value
+                                   && (sizeof (T) == 1 || sizeof (T) == 2
+                                       || sizeof (T) == 4
+                                       || sizeof (T) == 8)> {};
+
+/** the index of the first elem of arr equal to value, or n if none */
+template<typename T>
+size_t vl_scalar_find (const T *arr, size_t n, T value)
+{
+  for (size_t i = 0; i < n; ++i)
+    if (arr[i] == value)
+      return i;
+  return n;
+}
+/** the number of elems of arr equal to value */
+template<typename T>
+size_t vl_scalar_count (const T *arr, size_t n, T value)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i)
+    count += arr[i] == value;
+  return count;
+}
+
+#ifdef VL_SIMD_X86
+
+/** value in every lane of a 16 bytes register */
+template<typename T>
+__m128i vl_sse2_set1 (T value)
+{
+  if constexpr (std::is_same<T, float>::value)
+    return _mm_castps_si128 (_mm_set1_ps (value));
+  else if constexpr (std::is_same<T, double>::value)
+    return _mm_castpd_si128 (_mm_set1_pd (value));
+  else if constexpr (sizeof (T) == 1)
+    return _mm_set1_epi8 (static_cast<char> (value));
+  else if constexpr (sizeof (T) == 2)
+    return _mm_set1_epi16 (static_cast<short> (value));
+  else if constexpr (sizeof (T) == 4)
+    return _mm_set1_epi32 (static_cast<int> (value));
+  else
+    return _mm_set1_epi64x (static_cast<long long> (value));
+}
+/** all bytes of every lane where a and b hold equal T are set */
+template<typename T>
+__m128i vl_sse2_eq (__m128i a, __m128i b)
+{
+  if constexpr (std::is_same<T, float>::value)
+    return _mm_castps_si128 (_mm_cmpeq_ps (_mm_castsi128_ps (a),
+                                           _mm_castsi128_ps (b)));
+  else if constexpr (std::is_same<T, double>::value)
+    return _mm_castpd_si128 (_mm_cmpeq_pd (_mm_castsi128_pd (a),
+                                           _mm_castsi128_pd (b)));
+  else if constexpr (sizeof (T) == 1)
+    return _mm_cmpeq_epi8 (a, b);
+  else if constexpr (sizeof (T) == 2)
+    return _mm_cmpeq_epi16 (a, b);
+  else if constexpr (sizeof (T) == 4)
+    return _mm_cmpeq_epi32 (a, b);
+  else
+    { // no 64 bit compare in SSE2 - both 32 bit halves must be equal
+      __m128i halves = _mm_cmpeq_epi32 (a, b);
+      return _mm_and_si128 (halves, _mm_shuffle_epi32 (halves,
+                                                       _MM_SHUFFLE (2, 3, 0,
+                                                                    1)));
+    }
+}
+/** vl_scalar_find, 16 bytes at a time */
+template<typename T>
+size_t vl_sse2_find (const T *arr, size_t n, T value)
+{
+  constexpr size_t lanes = 16 / sizeof (T);
+  const __m128i needle = vl_sse2_set1 (value);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+    {
+      __m128i block =
+          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (arr + i));
+      unsigned mask = _mm_movemask_epi8 (vl_sse2_eq<T> (block, needle));
+      if (mask != 0)
+        return i + __builtin_ctz (mask) / sizeof (T);
+    }
+  return i + vl_scalar_find (arr + i, n - i, value);
+}
+/** vl_scalar_count, 16 bytes at a time */
+template<typename T>
+size_t vl_sse2_count (const T *arr, size_t n, T value)
+{
+  constexpr size_t lanes = 16 / sizeof (T);
+  const __m128i needle = vl_sse2_set1 (value);
+  size_t count_bits = 0;
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+    {
+      __m128i block =
+          _mm_loadu_si128 (reinterpret_cast<const __m128i *> (arr + i));
+      count_bits += __builtin_popcount (
+          _mm_movemask_epi8 (vl_sse2_eq<T> (block, needle)));
+    }
+  return count_bits / sizeof (T) + vl_scalar_count (arr + i, n - i, value);
+}
+
+/** value in every lane of a 32 bytes register */
+template<typename T>
+__attribute__ ((target ("avx2"))) __m256i vl_avx2_set1 (T value)
+{
+  if constexpr (std::is_same<T, float>::value)
+    return _mm256_castps_si256 (_mm256_set1_ps (value));
+  else if constexpr (std::is_same<T, double>::value)
+    return _mm256_castpd_si256 (_mm256_set1_pd (value));
+  else if constexpr (sizeof (T) == 1)
+    return _mm256_set1_epi8 (static_cast<char> (value));
+  else if constexpr (sizeof (T) == 2)
+    return _mm256_set1_epi16 (static_cast<short> (value));
+  else if constexpr (sizeof (T) == 4)
+    return _mm256_set1_epi32 (static_cast<int> (value));
+  else
+    return _mm256_set1_epi64x (static_cast<long long> (value));
+}
+/** all bytes of every lane where a and b hold equal T are set */
+template<typename T>
+__attribute__ ((target ("avx2"))) __m256i vl_avx2_eq (__m256i a, __m256i b)
+{
+  if constexpr (std::is_same<T, float>::value)
+    return _mm256_castps_si256 (_mm256_cmp_ps (_mm256_castsi256_ps (a),
+                                               _mm256_castsi256_ps (b),
+                                               _CMP_EQ_OQ));
+  else if constexpr (std::is_same<T, double>::value)
+    return _mm256_castpd_si256 (_mm256_cmp_pd (_mm256_castsi256_pd (a),
+                                               _mm256_castsi256_pd (b),
+                                               _CMP_EQ_OQ));
+  else if constexpr (sizeof (T) == 1)
+    return _mm256_cmpeq_epi8 (a, b);
+  else if constexpr (sizeof (T) == 2)
+    return _mm256_cmpeq_epi16 (a, b);
+  else if constexpr (sizeof (T) == 4)
+    return _mm256_cmpeq_epi32 (a, b);
+  else
+    return _mm256_cmpeq_epi64 (a, b);
+}
+/** vl_scalar_find, 32 bytes at a time */
+template<typename T>
+__attribute__ ((target ("avx2")))
+size_t vl_avx2_find (const T *arr, size_t n, T value)
+{
+  constexpr size_t lanes = 32 / sizeof (T);
+  const __m256i needle = vl_avx2_set1 (value);
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+    {
+      __m256i block =
+          _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (arr + i));
+      unsigned mask = static_cast<unsigned> (
+          _mm256_movemask_epi8 (vl_avx2_eq<T> (block, needle)));
+      if (mask != 0)
+        return i + __builtin_ctz (mask) / sizeof (T);
+    }
+  return i + vl_scalar_find (arr + i, n - i, value);
+}
+/** vl_scalar_count, 32 bytes at a time */
+template<typename T>
+__attribute__ ((target ("avx2")))
+size_t vl_avx2_count (const T *arr, size_t n, T value)
+{
+  constexpr size_t lanes = 32 / sizeof (T);
+  const __m256i needle = vl_avx2_set1 (value);
+  size_t count_bits = 0;
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes)
+    {
+      __m256i block =
+          _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (arr + i));
+      count_bits += __builtin_popcount (static_cast<unsigned> (
+          _mm256_movemask_epi8 (vl_avx2_eq<T> (block, needle))));
+    }
+  return count_bits / sizeof (T) + vl_scalar_count (arr + i, n - i, value);
+}
+
+/** tells (once, on the first call) if the cpu runs AVX2 */
+inline bool vl_cpu_has_avx2 ()
+{
+  static const bool has_avx2 = []
+  {
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("avx2") != 0;
+  } ();
+  return has_avx2;
+}
+
+#endif //VL_SIMD_X86
+
+/**
+ * the index of the first elem of arr equal to value, or n if none
+ * @tparam T an arithmetic type, see vl_simd_supported
+ * @param arr the elems to search
+ * @param n the number of elems
+ * @param value the value to look for
+ */
+template<typename T>
+size_t vl_simd_find (const T *arr, size_t n, T value)
+{
+  static_assert (vl_simd_supported<T>::value, "no search kernel for T");
+#ifdef VL_SIMD_X86
+  if (vl_cpu_has_avx2 ())
+    return vl_avx2_find (arr, n, value);
+  return vl_sse2_find (arr, n, value);
+#else
+  return vl_scalar_find (arr, n, value);
+#endif
+}
+/**
+ * the number of elems of arr equal to value
+ * @tparam T an arithmetic type, see vl_simd_supported
+ * @param arr the elems to count in
+ * @param n the number of elems
+ * @param value the value to count
+ */
+template<typename T>
+size_t vl_simd_count (const T *arr, size_t n, T value)
+{
+  static_assert (vl_simd_supported<T>::value, "no search kernel for T");
+#ifdef VL_SIMD_X86
+  if (vl_cpu_has_avx2 ())
+    return vl_avx2_count (arr, n, value);
+  return vl_sse2_count (arr, n, value);
+#else
+  return vl_scalar_count (arr, n, value);
+#endif
+}
+/**
+ * tells if the arrays hold equal elems. types whose equal values have equal
+ * bytes are compared with memcmp, others elem by elem
+ * @tparam T the elems type
+ */
+template<typename T>
+bool vl_equal (const T *lhs, const T *rhs, size_t n)
+{
+  if constexpr (std::has_unique_object_representations<T>::value)
+    return n == 0 || std::memcmp (lhs, rhs, n * sizeof (T)) == 0;
+  else
+    return std::equal (lhs, lhs + n, rhs);
+}
+
+#endif //_VL_SIMD_H_
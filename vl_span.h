@@ -0,0 +1,93 @@
+#ifndef _VL_SPAN_H_
+#define _VL_SPAN_H_
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * a view of count contiguous elems that it doesn't own - a vl_vector's
+ * elems, or a part of them. slicing it never copies. it is valid as long as
+ * the elems don't move, so until the vector they came from grows, shrinks or
+ * dies. the C++17 stand in for std::span
+ * @tparam T the elems type, const T for a read only view
+ */
+template<typename T>
+class vl_span {
+ public:
+  typedef T element_type;
+  typedef typename std::remove_cv<T>::type value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T &reference;
+  typedef T *pointer;
+  typedef T *iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+
+  /** an empty view */
+  vl_span () : _data (nullptr), _size (0)
+  {}
+  /** a view of the count elems from data on */
+  vl_span (T *data, size_t count) : _data (data), _size (count)
+  {}
+  /** a view of [first, last) */
+  vl_span (T *first, T *last) : _data (first), _size (last - first)
+  {}
+  /** a read only view of a writable one */
+  template<typename U, typename = typename std::enable_if<
+      std::is_same<const U, T>::value>::type>
+  vl_span (const vl_span<U> &other) : _data (other.data ()),
+                                      _size (other.size ())
+  {}
+
+  iterator begin () const
+  { return _data; }
+  iterator end () const
+  { return _data + _size; }
+  reverse_iterator rbegin () const
+  { return reverse_iterator (end ()); }
+  reverse_iterator rend () const
+  { return reverse_iterator (begin ()); }
+
+  T *data () const
+  { return _data; }
+  size_t size () const
+  { return _size; }
+  size_t size_bytes () const
+  { return _size * sizeof (T); }
+  bool empty () const
+  { return _size == 0; }
+
+  T &operator[] (size_t index) const
+  { return _data[index]; }
+  T &front () const
+  { return _data[0]; }
+  T &back () const
+  { return _data[_size - 1]; }
+
+  /** the first count elems */
+  vl_span first (size_t count) const
+  { return vl_span (_data, count); }
+  /** the last count elems */
+  vl_span last (size_t count) const
+  { return vl_span (_data + _size - count, count); }
+  /**
+   * count elems from offset on, or all the rest of them. throws out of range
+   * if offset is past the end
+   */
+  vl_span subspan (size_t offset, size_t count = static_cast<size_t> (-1))
+  const
+  {
+    if (offset > _size)
+      throw std::out_of_range ("Offset Out of Range");
+    size_t rest = _size - offset;
+    return vl_span (_data + offset, count < rest ? count : rest);
+  }
+
+ private:
+  T *_data;
+  size_t _size;
+};
+
+#endif //_VL_SPAN_H_
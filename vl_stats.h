@@ -0,0 +1,282 @@
+#ifndef _VL_STATS_H_
+#define _VL_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * storage statistics for tuning StaticCapacity per use site. off unless
+ * VL_ENABLE_STATS is defined for the whole program - then every vl_vector
+ * and vl_string instantiation counts, with relaxed atomics:
+ *   spill     - the elems moved from the static array to the heap
+ *   realloc   - the heap array was replaced by a bigger / smaller one
+ *   expand    - the heap array was resized by the allocator, in place or
+ *               realloc style
+ *   to_static - the elems moved back from the heap to the static array
+ *   copy      - elems built as copies of other elems
+ * and a histogram of the sizes vectors had when they died. the report is
+ * written at exit - as json to the file named by the VL_STATS_OUT env var,
+ * or as text to stderr - or on demand with vl_stats_report. without
+ * VL_ENABLE_STATS the hooks are empty inline functions, so they cost nothing
+ */
+
+/** the events that are counted */
+enum vl_stat_event {
+  vl_stat_spill,
+  vl_stat_realloc,
+  vl_stat_expand,
+  vl_stat_to_static,
+  vl_stat_copy,
+  vl_stat_events
+};
+
+#ifdef VL_ENABLE_STATS
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * the size histogram buckets - one per size up to vl_stats_exact_sizes, then
+ * one per power of two
+ */
+constexpr size_t vl_stats_exact_sizes = 64;
+constexpr size_t vl_stats_buckets = vl_stats_exact_sizes + 1 + 58;
+
+/** the bucket of a size */
+inline size_t vl_stats_bucket (size_t size)
+{
+  if (size <= vl_stats_exact_sizes)
+    return size;
+  // 65 - 127 go to the first power of two bucket, 128 - 255 to the next...
+  size_t log2 = sizeof (unsigned long long) * 8 - 1 - __builtin_clzll (size);
+  return std::min (vl_stats_exact_sizes + log2 - 5, vl_stats_buckets - 1);
+}
+/** the smallest size in a bucket */
+inline size_t vl_stats_bucket_min (size_t bucket)
+{
+  if (bucket <= vl_stats_exact_sizes)
+    return bucket;
+  return std::max (vl_stats_exact_sizes + 1,
+                   size_t (1) << (bucket - vl_stats_exact_sizes + 5));
+}
+
+/** the counters of one vl_vector instantiation */
+struct vl_stats_site {
+  vl_stats_site (std::string type_name, size_t capacity, size_t size_of_elem)
+      : name (std::move (type_name)), static_capacity (capacity),
+        elem_size (size_of_elem)
+  {}
+
+  std::string name;
+  size_t static_capacity;
+  size_t elem_size;
+  std::atomic<uint64_t> events[vl_stat_events] = {};
+  std::atomic<uint64_t> sizes[vl_stats_buckets] = {};
+
+  /** the number of vectors that died */
+  uint64_t died () const
+  {
+    uint64_t total = 0;
+    for (const auto &count : sizes)
+      total += count.load (std::memory_order_relaxed);
+    return total;
+  }
+  /**
+   * the smallest size that at least fraction of the dead vectors had or
+   * less - a bucket's lowest size past the exact ones
+   */
+  size_t percentile (double fraction) const
+  {
+    uint64_t total = died ();
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < vl_stats_buckets; ++bucket)
+      {
+        seen += sizes[bucket].load (std::memory_order_relaxed);
+        if (total > 0 && seen >= fraction * total)
+          return vl_stats_bucket_min (bucket);
+      }
+    return 0;
+  }
+  /** the fraction of the dead vectors that had up to size elems */
+  double fit (size_t size) const
+  {
+    uint64_t total = died ();
+    if (total == 0)
+      return 1;
+    uint64_t fitting = 0;
+    for (size_t bucket = 0; bucket < vl_stats_buckets
+                            && vl_stats_bucket_min (bucket) <= size; ++bucket)
+      fitting += sizes[bucket].load (std::memory_order_relaxed);
+    return static_cast<double> (fitting) / total;
+  }
+};
+
+/** all the sites, reported at exit */
+class vl_stats_registry {
+ public:
+  static vl_stats_registry &instance ()
+  { // never destroyed, vectors may die after the exit report
+    static vl_stats_registry *registry = new vl_stats_registry;
+    return *registry;
+  }
+
+  /** adds a site, that lives as long as the program */
+  vl_stats_site *add (vl_stats_site *site)
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    if (_sites.empty ())
+      std::atexit (report_at_exit);
+    _sites.push_back (site);
+    return site;
+  }
+  /** the sites so far */
+  std::vector<const vl_stats_site *> sites ()
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    return std::vector<const vl_stats_site *> (_sites.begin (), _sites.end ());
+  }
+
+ private:
+  static void report_at_exit ();
+
+  std::mutex _mutex;
+  std::vector<vl_stats_site *> _sites;
+};
+
+/** the readable name of a type */
+inline std::string vl_stats_type_name (const std::type_info &type)
+{
+  int status = 0;
+  std::unique_ptr<char, void (*) (void *)> demangled (
+      abi::__cxa_demangle (type.name (), nullptr, nullptr, &status),
+      std::free);
+  return status == 0 ? demangled.get () : type.name ();
+}
+
+/** the site of a vl_vector instantiation, made on its first event */
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+vl_stats_site &vl_stats_site_of ()
+{
+  static vl_stats_site *site = vl_stats_registry::instance ().add (
+      new vl_stats_site (vl_stats_type_name (typeid (Container)),
+                         StaticCapacity, ElemSize));
+  return *site;
+}
+
+/** counts count events of a vl_vector instantiation */
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_stats_count (vl_stat_event event, size_t count = 1)
+{
+  vl_stats_site_of<Container, StaticCapacity, ElemSize> ().events[event]
+      .fetch_add (count, std::memory_order_relaxed);
+}
+/** records the size of a vector that died */
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_stats_died (size_t size)
+{
+  vl_stats_site_of<Container, StaticCapacity, ElemSize> ()
+      .sizes[vl_stats_bucket (size)].fetch_add (1, std::memory_order_relaxed);
+}
+
+/** the names of the events, as in the reports */
+inline const char *vl_stat_name (int event)
+{
+  static const char *names[vl_stat_events] = {"spill", "realloc", "expand",
+                                              "to_static", "copy"};
+  return names[event];
+}
+
+/**
+ * writes the report of every site - the counters, the size percentiles and
+ * how many of the dead vectors fit in their static array
+ * @param os where to write
+ * @param json json if true, text lines otherwise
+ */
+inline void vl_stats_report (std::ostream &os, bool json = false)
+{
+  std::vector<const vl_stats_site *> sites = vl_stats_registry::instance ()
+      .sites ();
+  if (json)
+    os << "[\n";
+  for (size_t i = 0; i < sites.size (); ++i)
+    {
+      const vl_stats_site &site = *sites[i];
+      size_t static_bytes = site.static_capacity * site.elem_size;
+      if (json)
+        {
+          os << "  {\"type\": \"" << site.name << "\", \"static_capacity\": "
+             << site.static_capacity << ", \"elem_size\": " << site.elem_size
+             << ", \"died\": " << site.died ();
+          for (int event = 0; event < vl_stat_events; ++event)
+            os << ", \"" << vl_stat_name (event) << "\": "
+               << site.events[event].load (std::memory_order_relaxed);
+          os << ", \"p50\": " << site.percentile (0.5) << ", \"p90\": "
+             << site.percentile (0.9) << ", \"p99\": " << site.percentile (0.99)
+             << ", \"fit_static\": " << site.fit (site.static_capacity)
+             << ", \"sizes\": [";
+          bool first = true;
+          for (size_t bucket = 0; bucket < vl_stats_buckets; ++bucket)
+            {
+              uint64_t count = site.sizes[bucket].load (
+                  std::memory_order_relaxed);
+              if (count == 0)
+                continue;
+              os << (first ? "" : ", ") << "[" << vl_stats_bucket_min (bucket)
+                 << ", " << count << "]";
+              first = false;
+            }
+          os << "]}" << (i + 1 < sites.size () ? "," : "") << "\n";
+        }
+      else
+        {
+          os << site.name << "\n  static " << site.static_capacity
+             << " elems (" << static_bytes << " bytes), " << site.died ()
+             << " died -";
+          for (int event = 0; event < vl_stat_events; ++event)
+            os << " " << vl_stat_name (event) << " "
+               << site.events[event].load (std::memory_order_relaxed);
+          os << "\n  sizes p50 " << site.percentile (0.5) << " p90 "
+             << site.percentile (0.9) << " p99 " << site.percentile (0.99)
+             << ", " << 100 * site.fit (site.static_capacity)
+             << "% fit in the static array\n";
+        }
+    }
+  if (json)
+    os << "]\n";
+}
+
+inline void vl_stats_registry::report_at_exit ()
+{
+  std::ostringstream report;
+  const char *path = std::getenv ("VL_STATS_OUT");
+  vl_stats_report (report, path != nullptr);
+  std::FILE *out = path != nullptr ? std::fopen (path, "w") : stderr;
+  if (out == nullptr)
+    return;
+  std::fputs (report.str ().c_str (), out);
+  if (out != stderr)
+    std::fclose (out);
+}
+
+#else
+
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_stats_count (vl_stat_event, size_t = 1)
+{}
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_stats_died (size_t)
+{}
+
+#endif //VL_ENABLE_STATS
+
+#endif //_VL_STATS_H_
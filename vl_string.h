@@ -2,147 +2,1385 @@
 #ifndef _VL_STRING_H_
 #define _VL_STRING_H_
 
+#include "vl_hash.h"
+#include "vl_search.h"
 #include "vl_vector.h"
+#include <cstdarg>
+#include <cstdio>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <stdexcept>
+#include <string_view>
 
-template<size_t StaticCapacity = DEF_STATIC_CAP>
-class vl_string : public vl_vector<char, StaticCapacity> {
+template<class Lhs, class Rhs> class vl_string_concat;
+template<size_t StaticCapacity, class Allocator> class vl_string_builder;
+
+/**
+ * a string with its chars in the object itself while they fit (small string
+ * optimization), and in a heap array after that. the object is the chars
+ * array: the heap array pointer, size and capacity overlap its start, and its
+ * last byte tells which of the two it holds - the number of free inline chars,
+ * or a flag with its high bit on for a heap string. so every byte that is not
+ * the flag holds chars, vl_string<> is 24 bytes with 23 inline chars.
+ *
+ * the null terminator is not kept up by the members that change the chars,
+ * appending a char is one store and a size update. c_str and the
+ * const char * conversion write it - there is always room for it, a full
+ * inline string's free chars count is 0 and is the terminator. that write
+ * makes them the only const members that must not run on one string in
+ * several threads at once. data () is not null terminated.
+ *
+ * nothing in the object points into it, so strings are trivially relocatable
+ * - a vl_vector of them moves them with memcpy
+ * @tparam StaticCapacity the minimum number of inline chars, it is rounded up
+ *                        to fill the object (see inline_capacity)
+ * @tparam Allocator where the heap array comes from
+ */
+template<size_t StaticCapacity = DEF_STATIC_CAP,
+    class Allocator = std::allocator<char>>
+class vl_string : private Allocator {
+  static_assert (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+                 "the heap flag is the high byte of the capacity");
+
+  typedef std::allocator_traits<Allocator> alloc_traits;
+
+  // the free inline chars count takes a byte up to 127 inline chars, a size_t
+  // after that
+  static constexpr bool _small_tag = StaticCapacity < 128;
+  static constexpr size_t _tag_size = _small_tag ? 1 : sizeof (size_t);
+  static constexpr size_t _heap_bytes = 2 * sizeof (size_t) + sizeof (char *);
 
  public:
-  /** def ctr */
-  vl_string () : vl_vector<char, StaticCapacity> (1, '\0')
-  {}
-  /** cpy ctr */
-  vl_string (const vl_string<StaticCapacity> &other) :
-      vl_vector<char, StaticCapacity> (other)
-  {}
-  /** implicit ctr - the plus 1 for adding the "\0" terminator */
-  vl_string (const char *str_to_cpy) :
-      vl_vector<char, StaticCapacity> (str_to_cpy,
-                                       str_to_cpy + strlen (str_to_cpy) + 1)
-  {}
+  /** the chars that fit in the object */
+  static constexpr size_t inline_capacity =
+      _small_tag ? std::max (_heap_bytes - 1,
+                             (StaticCapacity + 1 + sizeof (size_t) - 1)
+                             / sizeof (size_t) * sizeof (size_t) - 1)
+                 : (StaticCapacity + sizeof (size_t) - 1) / sizeof (size_t)
+                   * sizeof (size_t);
 
-  // iterators typedefs
+  typedef char value_type;
+  typedef Allocator allocator_type;
   typedef char *iterator;
   typedef const char *const_iterator;
   typedef std::reverse_iterator<iterator> reverse_iterator;
   typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
-  // all reverse iterators
-  reverse_iterator rbegin () override
-  { return std::reverse_iterator<iterator> (this->end () - 1); }
-  const_reverse_iterator rbegin () const override
-  { return std::reverse_iterator<const_iterator> (this->end () - 1); }
-  const_reverse_iterator crbegin () const override
-  { return std::reverse_iterator<const_iterator> (this->cend () - 1); }
+  /** def ctr */
+  vl_string ()
+  { set_inline_size (0); }
+  /** empty string that takes its heap memory from alloc */
+  explicit vl_string (const Allocator &alloc) : Allocator (alloc)
+  { set_inline_size (0); }
+  /** cpy ctr - the heap array, if one is needed, is exactly the size */
+  vl_string (const vl_string &other)
+      : vl_string (other, alloc_traits::select_on_container_copy_construction
+      (other.get_allocator ()))
+  {}
+  /** cpy ctr that takes its heap memory from alloc */
+  vl_string (const vl_string &other, const Allocator &alloc)
+      : vl_string (other.data (), other.size (), alloc)
+  {}
+  /** move ctr - takes the bytes as they are, the moved from string is left
+   * empty */
+  vl_string (vl_string &&other) noexcept
+      : Allocator (std::move (other.alloc ()))
+  {
+    std::memcpy (_bytes, other._bytes, sizeof (_bytes));
+    other.set_inline_size (0);
+  }
+  /** implicit ctr from a c string */
+  vl_string (const char *str_to_cpy, const Allocator &alloc = Allocator ()) :
+      vl_string (str_to_cpy, strlen (str_to_cpy), alloc)
+  {}
+  /** the first len chars of str, no strlen */
+  vl_string (const char *str, size_t len,
+             const Allocator &alloc = Allocator ()) : Allocator (alloc)
+  {
+    set_inline_size (0);
+    reserve (len);
+    std::memcpy (raw (), str, len);
+    set_size (len);
+  }
+  /** the chars of a view, no strlen */
+  explicit vl_string (std::string_view str,
+                      const Allocator &alloc = Allocator ()) :
+      vl_string (str.data (), str.size (), alloc)
+  {}
+  /** destructor */
+  ~vl_string ()
+  {
+    vl_stats_died<vl_string, inline_capacity, 1> (size ());
+    trace (vl_trace_destroy);
+    free_heap ();
+  }
+
+  Allocator get_allocator () const
+  { return alloc (); }
 
-  size_t size () const override
-  { return this->_size - 1; }
+  // iterators
+  iterator begin ()
+  { return data (); }
+  const_iterator begin () const
+  { return data (); }
+  const_iterator cbegin () const
+  { return data (); }
+  iterator end ()
+  { return data () + size (); }
+  const_iterator end () const
+  { return data () + size (); }
+  const_iterator cend () const
+  { return data () + size (); }
+  reverse_iterator rbegin ()
+  { return reverse_iterator (end ()); }
+  const_reverse_iterator rbegin () const
+  { return const_reverse_iterator (end ()); }
+  const_reverse_iterator crbegin () const
+  { return const_reverse_iterator (end ()); }
+  reverse_iterator rend ()
+  { return reverse_iterator (begin ()); }
+  const_reverse_iterator rend () const
+  { return const_reverse_iterator (begin ()); }
+  const_reverse_iterator crend () const
+  { return const_reverse_iterator (begin ()); }
 
-  void push_back (const char &elem) override
+  size_t size () const
+  { return on_heap () ? heap_size () : inline_size (); }
+  bool empty () const
+  { return size () == 0; }
+  /** the chars that fit without a new heap array, not counting the
+   * terminator */
+  size_t capacity () const
+  { return on_heap () ? heap_cap () : inline_capacity; }
+  /** the chars, not null terminated - see c_str */
+  char *data ()
+  { return raw (); }
+  const char *data () const
+  { return raw (); }
+  /** the chars, null terminated */
+  const char *c_str () const
   {
-    this->insert (this->cend () - 1, elem);
+    char *chars = raw ();
+    chars[size ()] = '\0';
+    return chars;
   }
+  operator const char * () const
+  { return c_str (); }
+  /** a writable view of the chars */
+  vl_span<char> as_span ()
+  { return vl_span<char> (data (), size ()); }
+  vl_span<const char> as_span () const
+  { return vl_span<const char> (data (), size ()); }
 
-  void pop_back () override
-  { if (size () > 0) this->erase (this->end () - 2); }
+  char &at (size_t index);
+  char at (size_t index) const;
+  char &operator[] (size_t index)
+  { return data ()[index]; }
+  char operator[] (size_t index) const
+  { return data ()[index]; }
+  char &front ()
+  { return data ()[0]; }
+  char front () const
+  { return data ()[0]; }
+  char &back ()
+  { return data ()[size () - 1]; }
+  char back () const
+  { return data ()[size () - 1]; }
 
-  void clear () override
-  { if (this->size () > 0) this->erase (this->begin (), this->end () - 1); }
+  /** appends a char - a store and a size update while there is room */
+  void push_back (char elem)
+  {
+    trace (vl_trace_push);
+    size_t old_size;
+    if (!on_heap ())
+      {
+        old_size = inline_size ();
+        if (old_size < inline_capacity)
+          {
+            inline_chars ()[old_size] = elem;
+            set_inline_size (old_size + 1);
+            return;
+          }
+      }
+    else
+      {
+        old_size = heap_size ();
+        if (old_size < heap_cap ())
+          {
+            heap_arr ()[old_size] = elem;
+            set_heap_size (old_size + 1);
+            return;
+          }
+      }
+    grow_by (1);
+    raw ()[old_size] = elem;
+    set_size (old_size + 1);
+  }
+  char &emplace_back (char elem)
+  {
+    push_back (elem);
+    return back ();
+  }
+  void pop_back ()
+  {
+    size_t old_size = size ();
+    if (old_size > 0)
+      {
+        trace (vl_trace_pop);
+        set_size (old_size - 1);
+      }
+  }
+  /** empties the string, the heap array is kept */
+  void clear ()
+  {
+    trace (vl_trace_erase, 0, size ());
+    set_size (0);
+  }
+
+  iterator insert (const_iterator position, char elem)
+  { return insert (position, &elem, &elem + 1); }
+  /** inserts [first, last), which may be chars of this string */
+  template<class InputIterator>
+  iterator insert (const_iterator position, InputIterator first,
+                   InputIterator last);
+  /** appends [first, last) */
+  template<class InputIterator>
+  iterator append (InputIterator first, InputIterator last)
+  { return insert (cend (), first, last); }
+  iterator erase (const_iterator elem_to_remove)
+  { return erase (elem_to_remove, elem_to_remove + 1); }
+  iterator erase (const_iterator first, const_iterator last);
+
+  /**
+   * resizes the string, new chars are copies of fill. it grows by the
+   * growth policy, like push_back - reserve gives an exact size
+   */
+  void resize (size_t len, char fill = '\0');
+  /** resizes the string, new chars are left for the caller to overwrite */
+  void resize_for_overwrite (size_t len)
+  {
+    trace (vl_trace_resize, 0, len);
+    size_t old_size = size ();
+    if (len > old_size)
+      grow_by (len - old_size);
+    set_size (len);
+  }
+  /**
+   * appends len chars left for the caller to overwrite, and returns the
+   * first of them
+   */
+  char *append_uninitialized (size_t len)
+  {
+    size_t old_size = size ();
+    trace (vl_trace_insert, old_size, len);
+    grow_by (len);
+    set_size (old_size + len);
+    return data () + old_size;
+  }
+  /** replaces the chars with [first, last) */
+  template<class InputIterator>
+  void assign (InputIterator first, InputIterator last)
+  {
+    clear ();
+    insert (cend (), first, last);
+  }
+  /** makes room for new_cap chars, the heap array is exactly that big */
+  void reserve (size_t new_cap)
+  {
+    trace (vl_trace_reserve, 0, new_cap);
+    if (new_cap > capacity ())
+      realloc_heap (new_cap);
+  }
+  /** back to the inline chars if they fit, or a heap array of the size */
+  void shrink_to_fit ();
+  void swap (vl_string &other) noexcept;
+
+  static constexpr size_t npos = vl_npos;
 
-  virtual bool contains (const char *substr) const;
+  /** a view of the chars */
+  std::string_view sv () const
+  { return std::string_view (data (), size ()); }
+  /**
+   * a view of len chars from pos on, or all the rest of them - the chars are
+   * not copied. throws out of range if pos is past the end
+   */
+  std::string_view substr (size_t pos, size_t len = npos) const
+  {
+    if (pos > size ())
+      throw std::out_of_range ("Position Out of Range");
+    return sv ().substr (pos, len);
+  }
+  /** the fields between delimiters, as views into this string */
+  vl_split_view split (char delim) const
+  { return vl_split_view (sv (), delim); }
+  vl_split_view split (std::string_view delim) const
+  { return vl_split_view (sv (), delim); }
+
+  bool contains (const char *substr) const;
+  bool contains (char single_char) const
+  { return find (single_char) != npos; }
+  bool contains (const vl_string_searcher &searcher) const
+  { return find (searcher) != npos; }
+  bool contains (std::string_view substr) const
+  { return find (substr) != npos; }
+
+  /** search functions - positions of chars / substrings, or npos */
+  size_t find (const char *substr, size_t pos = 0) const
+  { return vl_find (data (), size (), substr, strlen (substr), pos); }
+  size_t find (const vl_string &substr, size_t pos = 0) const
+  { return vl_find (data (), size (), substr.data (), substr.size (), pos); }
+  size_t find (std::string_view substr, size_t pos = 0) const
+  { return vl_find (data (), size (), substr.data (), substr.size (), pos); }
+  size_t find (char single_char, size_t pos = 0) const
+  { return vl_find (data (), size (), &single_char, 1, pos); }
+  size_t find (const vl_string_searcher &searcher, size_t pos = 0) const
+  { return searcher.find (data (), size (), pos); }
+  size_t rfind (const char *substr, size_t pos = npos) const
+  { return vl_rfind (data (), size (), substr, strlen (substr), pos); }
+  size_t rfind (char single_char, size_t pos = npos) const
+  { return vl_rfind (data (), size (), &single_char, 1, pos); }
+  size_t find_first_of (const char *chars, size_t pos = 0) const
+  { return vl_find_first_of (data (), size (), chars, strlen (chars), pos); }
 
   /** class operators implementations */
-  vl_string<StaticCapacity> &
-  operator+= (const vl_string<StaticCapacity> &other);
-  vl_string<StaticCapacity> &operator+= (const char *str);
-  vl_string<StaticCapacity> &operator+= (char single_char);
-  vl_string<StaticCapacity> operator+ (const vl_string<StaticCapacity> &other)
-  const;
-  vl_string<StaticCapacity> operator+ (const char *str) const;
-  vl_string<StaticCapacity> operator+ (char single_char) const;
-
-  operator const char * () const;
+  vl_string &
+  operator= (const vl_string &other);
+  vl_string &
+  operator= (vl_string &&other)
+  noexcept (alloc_traits::propagate_on_container_move_assignment::value
+            || alloc_traits::is_always_equal::value);
+  vl_string &
+  operator+= (const vl_string &other);
+  vl_string &operator+= (const char *str);
+  vl_string &operator+= (char single_char);
+  vl_string &operator+= (std::string_view str)
+  { return append (str.data (), str.size ()); }
+  template<class Lhs, class Rhs>
+  vl_string &operator+= (const vl_string_concat<Lhs, Rhs> &expr)
+  { return append (expr); }
+
+  /** appends len chars from str, which may point into this string */
+  vl_string &append (const char *str, size_t len);
+  /** appends all the pieces of a + b + ... with at most one allocation */
+  template<class Lhs, class Rhs>
+  vl_string &append (const vl_string_concat<Lhs, Rhs> &expr);
+
+  /** comp operators */
+  friend bool operator== (const vl_string &lhs, const vl_string &rhs)
+  { return lhs.sv () == rhs.sv (); }
+  friend bool operator== (const vl_string &lhs, const char *rhs)
+  { return lhs.sv () == rhs; }
+  friend bool operator== (const char *lhs, const vl_string &rhs)
+  { return rhs.sv () == lhs; }
+  friend bool operator!= (const vl_string &lhs, const vl_string &rhs)
+  { return !(lhs == rhs); }
+  friend bool operator!= (const vl_string &lhs, const char *rhs)
+  { return !(lhs == rhs); }
+  friend bool operator!= (const char *lhs, const vl_string &rhs)
+  { return !(lhs == rhs); }
+  /** < 0, 0 or > 0 as this string comes before, with or after other -
+   * memcmp order, chars as unsigned */
+  int compare (std::string_view other) const
+  { return sv ().compare (other); }
+  template<size_t OtherCapacity, class OtherAllocator>
+  int compare (const vl_string<OtherCapacity, OtherAllocator> &other) const
+  { return sv ().compare (other.sv ()); }
+  /** ordering operators */
+  friend bool operator< (const vl_string &lhs, const vl_string &rhs)
+  { return lhs.compare (rhs) < 0; }
+  friend bool operator< (const vl_string &lhs, const char *rhs)
+  { return lhs.compare (rhs) < 0; }
+  friend bool operator< (const char *lhs, const vl_string &rhs)
+  { return rhs.compare (lhs) > 0; }
+  friend bool operator<= (const vl_string &lhs, const vl_string &rhs)
+  { return lhs.compare (rhs) <= 0; }
+  friend bool operator<= (const vl_string &lhs, const char *rhs)
+  { return lhs.compare (rhs) <= 0; }
+  friend bool operator<= (const char *lhs, const vl_string &rhs)
+  { return rhs.compare (lhs) >= 0; }
+  friend bool operator> (const vl_string &lhs, const vl_string &rhs)
+  { return rhs < lhs; }
+  friend bool operator> (const vl_string &lhs, const char *rhs)
+  { return rhs < lhs; }
+  friend bool operator> (const char *lhs, const vl_string &rhs)
+  { return rhs < lhs; }
+  friend bool operator>= (const vl_string &lhs, const vl_string &rhs)
+  { return rhs <= lhs; }
+  friend bool operator>= (const vl_string &lhs, const char *rhs)
+  { return rhs <= lhs; }
+  friend bool operator>= (const char *lhs, const vl_string &rhs)
+  { return rhs <= lhs; }
+
+ private:
+  template<size_t, class> friend class vl_string_builder;
+
+  Allocator &alloc ()
+  { return *this; }
+  const Allocator &alloc () const
+  { return *this; }
+
+  // the bytes of the object, read and written with memcpy. inline - the
+  // chars, then the free chars count. heap - the array, its size and its
+  // capacity, then the flag in the last byte
+  bool on_heap () const
+  { return _bytes[sizeof (_bytes) - 1] & 0x80; }
+  char *inline_chars () const
+  { return reinterpret_cast<char *> (_bytes); }
+  size_t inline_size () const
+  {
+    if constexpr (_small_tag)
+      return inline_capacity - _bytes[inline_capacity];
+    size_t free_chars;
+    std::memcpy (&free_chars, _bytes + inline_capacity, sizeof (free_chars));
+    return inline_capacity - free_chars;
+  }
+  void set_inline_size (size_t new_size)
+  {
+    if constexpr (_small_tag)
+      _bytes[inline_capacity] = static_cast<unsigned char> (inline_capacity
+                                                            - new_size);
+    else
+      {
+        size_t free_chars = inline_capacity - new_size;
+        std::memcpy (_bytes + inline_capacity, &free_chars,
+                     sizeof (free_chars));
+      }
+  }
+  char *heap_arr () const
+  {
+    char *arr;
+    std::memcpy (&arr, _bytes, sizeof (arr));
+    return arr;
+  }
+  size_t heap_size () const
+  {
+    size_t heap_size;
+    std::memcpy (&heap_size, _bytes + sizeof (char *), sizeof (heap_size));
+    return heap_size;
+  }
+  void set_heap_size (size_t new_size)
+  { std::memcpy (_bytes + sizeof (char *), &new_size, sizeof (new_size)); }
+  size_t heap_cap () const
+  {
+    size_t cap;
+    std::memcpy (&cap, _bytes + sizeof (char *) + sizeof (size_t),
+                 sizeof (cap));
+    return cap & ~(size_t (1) << (8 * sizeof (size_t) - 1));
+  }
+  /** makes arr, of cap chars and a terminator, the chars */
+  void set_heap (char *arr, size_t new_size, size_t cap)
+  {
+    std::memcpy (_bytes, &arr, sizeof (arr));
+    set_heap_size (new_size);
+    std::memcpy (_bytes + sizeof (char *) + sizeof (size_t), &cap,
+                 sizeof (cap));
+    _bytes[sizeof (_bytes) - 1] |= 0x80;
+  }
+  /** the chars, writable also through a const string - for the terminator */
+  char *raw () const
+  { return on_heap () ? heap_arr () : inline_chars (); }
+  void set_size (size_t new_size)
+  {
+    if (on_heap ())
+      set_heap_size (new_size);
+    else
+      set_inline_size (new_size);
+  }
+
+  /** a heap array of cap chars and a place for the terminator */
+  char *allocate (size_t cap)
+  { return alloc_traits::allocate (alloc (), cap + 1); }
+  void free_heap ()
+  {
+    if (on_heap ())
+      alloc_traits::deallocate (alloc (), heap_arr (), heap_cap () + 1);
+  }
+  /** makes new_arr, with the chars copied to it already, the heap array */
+  void adopt_heap (char *new_arr, size_t new_cap)
+  {
+    stat (on_heap () ? vl_stat_realloc : vl_stat_spill);
+    size_t old_size = size ();
+    free_heap ();
+    set_heap (new_arr, old_size, new_cap);
+  }
+  /**
+   * resizes the heap array to new_cap without building a new one, if the
+   * allocator can
+   */
+  bool resize_heap (size_t new_cap);
+  /** moves the chars to a heap array of new_cap chars */
+  void realloc_heap (size_t new_cap)
+  {
+    if (resize_heap (new_cap))
+      return;
+    char *new_arr = allocate (new_cap);
+    std::memcpy (new_arr, data (), size ());
+    adopt_heap (new_arr, new_cap);
+  }
+  /** the capacity the growth policy gives for count more chars */
+  size_t cap_func (size_t count) const
+  { return vl_growth_1_5x::capacity (size () + count, 1); }
+  /** makes room for len more chars, growing by the growth policy */
+  void grow_by (size_t len)
+  {
+    if (size () + len > capacity ())
+      realloc_heap (cap_func (len));
+  }
+  /**
+   * appends len chars that write puts at the char * it gets. if from_self,
+   * the chars come from this string, so on growth the old array is freed
+   * only after write is done
+   */
+  template<class Writer>
+  void append_with (size_t len, bool from_self, Writer write);
+  /** counts count events, if VL_ENABLE_STATS is defined - see vl_stats.h */
+  static void stat (vl_stat_event event, size_t count = 1)
+  { vl_stats_count<vl_string, inline_capacity, 1> (event, count); }
+  /** records an op, if VL_ENABLE_TRACE is defined - see vl_trace.h */
+  void trace (vl_trace_op op, size_t pos = 0, size_t count = 0) const
+  { vl_trace<vl_string, inline_capacity, 1> (this, size (), op, pos, count); }
+
+  alignas (size_t) mutable unsigned char _bytes[inline_capacity + _tag_size];
 };
 
+/** strings move with memcpy, if their allocator does */
+template<size_t StaticCapacity, class Allocator>
+struct vl_is_trivially_relocatable<vl_string<StaticCapacity, Allocator>>
+    : std::integral_constant<bool, std::is_empty<Allocator>::value
+                                   || vl_is_trivially_relocatable<
+                                       Allocator>::value> {};
+
+/**
+ * the char at index, checked
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param index the index of the char
+ * @return the char
+ */
+template<size_t StaticCapacity, class Allocator>
+char &vl_string<StaticCapacity, Allocator>::at (size_t index)
+{
+  if (index >= size ())
+    throw std::out_of_range ("Index Out of Range");
+  return data ()[index];
+}
+template<size_t StaticCapacity, class Allocator>
+char vl_string<StaticCapacity, Allocator>::at (size_t index) const
+{
+  if (index >= size ())
+    throw std::out_of_range ("Index Out of Range");
+  return data ()[index];
+}
+
 /**
  * checks if substring in string
  * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
  * @param substr the substring to search
- * @return
+ * @return true if substr is in the string
  */
-template<size_t StaticCapacity>
-bool vl_string<StaticCapacity>::contains (const char *substr) const
+template<size_t StaticCapacity, class Allocator>
+bool vl_string<StaticCapacity, Allocator>::contains
+    (const char *substr) const
 {
-  if (strlen (substr) > this->size ())
+  return find (substr) != npos;
+}
+
+/**
+ * inserts chars. forward iterators are counted first, so the string grows at
+ * most once - input iterators and chars of this string are copied to a
+ * string of their own first
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @tparam InputIterator type of iterator
+ * @param position where to insert
+ * @param first iterator of the first char to insert
+ * @param last iterator of the last char to insert
+ * @return iterator to the first inserted char
+ */
+template<size_t StaticCapacity, class Allocator>
+template<class InputIterator>
+typename vl_string<StaticCapacity, Allocator>::iterator
+vl_string<StaticCapacity, Allocator>::insert
+    (const_iterator position, InputIterator first, InputIterator last)
+{
+  size_t pos = position - cbegin ();
+  if constexpr (!std::is_base_of<std::forward_iterator_tag,
+                                 typename std::iterator_traits<
+                                     InputIterator>::iterator_category>::value)
+    {
+      vl_string chars (alloc ());
+      for (; first != last; ++first)
+        chars.push_back (*first);
+      return insert (cbegin () + pos, chars.cbegin (), chars.cend ());
+    }
+  else
+    {
+      if constexpr (std::is_convertible<InputIterator, const char *>::value)
+        {
+          std::less<const char *> before;
+          if (before (first, cend ()) && before (cbegin (), last))
+            {
+              vl_string chars (first, last - first, alloc ());
+              return insert (cbegin () + pos, chars.cbegin (), chars.cend ());
+            }
+        }
+      size_t count = std::distance (first, last);
+      size_t old_size = size ();
+      trace (vl_trace_insert, pos, count);
+      if (old_size + count > capacity ())
+        {
+          size_t new_cap = cap_func (count);
+          char *new_arr = allocate (new_cap);
+          std::memcpy (new_arr, data (), pos);
+          std::copy (first, last, new_arr + pos);
+          std::memcpy (new_arr + pos + count, data () + pos, old_size - pos);
+          adopt_heap (new_arr, new_cap);
+        }
+      else
+        {
+          char *chars = data ();
+          std::memmove (chars + pos + count, chars + pos, old_size - pos);
+          std::copy (first, last, chars + pos);
+        }
+      set_size (old_size + count);
+      return begin () + pos;
+    }
+}
+
+/**
+ * erases the chars in [first, last)
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param first iterator to the first char to remove
+ * @param last iterator past the last char to remove
+ * @return iterator to the char after the removed ones
+ */
+template<size_t StaticCapacity, class Allocator>
+typename vl_string<StaticCapacity, Allocator>::iterator
+vl_string<StaticCapacity, Allocator>::erase
+    (const_iterator first, const_iterator last)
+{
+  size_t pos = first - cbegin ();
+  size_t count = last - first;
+  size_t old_size = size ();
+  trace (vl_trace_erase, pos, count);
+  char *chars = data ();
+  std::memmove (chars + pos, chars + pos + count, old_size - pos - count);
+  set_size (old_size - count);
+  return chars + pos;
+}
+
+/**
+ * resizes the string - cuts it, or appends copies of fill
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param len the new length
+ * @param fill the char to append
+ */
+template<size_t StaticCapacity, class Allocator>
+void vl_string<StaticCapacity, Allocator>::resize (size_t len, char fill)
+{
+  trace (vl_trace_resize, 0, len);
+  size_t old_size = size ();
+  if (len > old_size)
+    {
+      grow_by (len - old_size);
+      std::memset (data () + old_size, fill, len - old_size);
+    }
+  set_size (len);
+}
+
+/**
+ * fits the capacity to the size - back to the inline chars if they fit, or a
+ * heap array of exactly size chars
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ */
+template<size_t StaticCapacity, class Allocator>
+void vl_string<StaticCapacity, Allocator>::shrink_to_fit ()
+{
+  trace (vl_trace_shrink);
+  if (!on_heap ())
+    return;
+  size_t old_size = size ();
+  if (old_size <= inline_capacity)
+    { // the chars overwrite the heap array pointer, keep it
+      stat (vl_stat_to_static);
+      char *heap_chars = heap_arr ();
+      size_t cap = heap_cap ();
+      std::memcpy (inline_chars (), heap_chars, old_size);
+      set_inline_size (old_size);
+      alloc_traits::deallocate (alloc (), heap_chars, cap + 1);
+    }
+  else if (old_size < heap_cap ())
+    {
+      char *new_arr = allocate (old_size);
+      std::memcpy (new_arr, heap_arr (), old_size);
+      adopt_heap (new_arr, old_size);
+    }
+}
+
+/**
+ * resizes the heap array to new_cap without building a new one - in place,
+ * or realloc style. returns false if the allocator can't, or the chars are
+ * inline
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param new_cap the new capacity
+ */
+template<size_t StaticCapacity, class Allocator>
+bool vl_string<StaticCapacity, Allocator>::resize_heap (size_t new_cap)
+{
+  if (!on_heap ())
     return false;
-  for (size_t i = 0; i < this->_size - strlen (substr); ++i)
-    if (this->at (i) == *substr)
-      {
-        for (size_t j = 0; j < strlen (substr); ++j)
-          if (substr[j] != this->at (i + j))
-            return false;
-        return true;
-      }
+  size_t cap = heap_cap ();
+  if constexpr (vl_has_try_expand<Allocator>::value)
+    {
+      if (new_cap > cap
+          && alloc ().try_expand (heap_arr (), cap + 1, new_cap + 1))
+        {
+          stat (vl_stat_expand);
+          set_heap (heap_arr (), heap_size (), new_cap);
+          return true;
+        }
+    }
+  if constexpr (vl_has_reallocate<Allocator>::value)
+    {
+      char *arr = alloc ().reallocate (heap_arr (), cap + 1, new_cap + 1);
+      stat (vl_stat_expand);
+      set_heap (arr, heap_size (), new_cap);
+      return true;
+    }
   return false;
 }
 
-/** friend operators */
-template<size_t StaticCapacity>
-vl_string<StaticCapacity> &vl_string<StaticCapacity>::operator+=
-    (const vl_string<StaticCapacity> &other)
-{ // insert new string without its null terminator
-  this->insert (this->cend () - 1, other.begin (), other.end () - 1);
+/** swaps the chars of the two strings, and their allocators if they
+ * propagate on swap */
+template<size_t StaticCapacity, class Allocator>
+void vl_string<StaticCapacity, Allocator>::swap (vl_string &other) noexcept
+{
+  if constexpr (alloc_traits::propagate_on_container_swap::value)
+    std::swap (alloc (), other.alloc ());
+  unsigned char bytes[sizeof (_bytes)];
+  std::memcpy (bytes, _bytes, sizeof (_bytes));
+  std::memcpy (_bytes, other._bytes, sizeof (_bytes));
+  std::memcpy (other._bytes, bytes, sizeof (_bytes));
+}
+/** swaps the content of the two strings */
+template<size_t StaticCapacity, class Allocator>
+void swap (vl_string<StaticCapacity, Allocator> &lhs,
+           vl_string<StaticCapacity, Allocator> &rhs) noexcept
+{ lhs.swap (rhs); }
+
+/**
+ * cpy assignment - the chars go to the array this string has if they fit in
+ * it
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param other the string to copy
+ * @return this string
+ */
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::operator= (const vl_string &other)
+{
+  if (this == &other)
+    return *this;
+  if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+    {
+      if (alloc () != other.alloc ())
+        {
+          free_heap ();
+          set_inline_size (0);
+        }
+      alloc () = other.alloc ();
+    }
+  size_t len = other.size ();
+  if (len > capacity ())
+    {
+      char *new_arr = allocate (len);
+      set_size (0);
+      adopt_heap (new_arr, len);
+    }
+  std::memcpy (data (), other.data (), len);
+  set_size (len);
   return *this;
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity> &vl_string<StaticCapacity>::operator+=
-    (const char *str)
+/** move assignment - the moved from string is left empty */
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::operator= (vl_string &&other)
+noexcept (alloc_traits::propagate_on_container_move_assignment::value
+          || alloc_traits::is_always_equal::value)
 {
-  this->insert (this->end () - 1, str, str + strlen (str));
+  if (this == &other)
+    return *this;
+  constexpr bool propagate =
+      alloc_traits::propagate_on_container_move_assignment::value;
+  if constexpr (!propagate && !alloc_traits::is_always_equal::value)
+    {
+      if (alloc () != other.alloc ())
+        { // our allocator can't free other's heap array, copy the chars
+          *this = other;
+          other.clear ();
+          return *this;
+        }
+    }
+  free_heap ();
+  if constexpr (propagate)
+    alloc () = std::move (other.alloc ());
+  std::memcpy (_bytes, other._bytes, sizeof (_bytes));
+  other.set_inline_size (0);
   return *this;
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity>
-&vl_string<StaticCapacity>::operator+= (const char single_char)
+/** friend operators */
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::operator+= (const vl_string &other)
+{
+  return append (other.data (), other.size ());
+}
+
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::operator+= (const char *str)
 {
-  this->push_back (single_char);
+  return append (str, strlen (str));
+}
+
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator>
+&vl_string<StaticCapacity, Allocator>::operator+= (const char single_char)
+{
+  push_back (single_char);
   return *this;
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity>
-vl_string<StaticCapacity>::operator+
-    (const vl_string<StaticCapacity> &other) const
+/**
+ * appends chars to the string
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @param str the chars to append, they may be a part of this string
+ * @param len the number of chars
+ * @return this string
+ */
+template<size_t StaticCapacity, class Allocator>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::append (const char *str, size_t len)
 {
-  vl_string<StaticCapacity> ret_val = *this;
-  ret_val += other;
-  return ret_val;
+  std::less_equal<const char *> before;
+  bool from_self = before (data (), str) && before (str, data () + size ());
+  append_with (len, from_self, [str, len] (char *dest)
+  { std::memcpy (dest, str, len); });
+  return *this;
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity>
-vl_string<StaticCapacity>::operator+ (const char *str) const
+/**
+ * appends the pieces of a concatenation - their total length is known, so
+ * the string grows at most once and every piece is copied once
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @tparam Lhs the left operand of the concatenation
+ * @tparam Rhs the right operand of the concatenation
+ * @param expr the concatenation, its pieces may be parts of this string
+ * @return this string
+ */
+template<size_t StaticCapacity, class Allocator>
+template<class Lhs, class Rhs>
+vl_string<StaticCapacity, Allocator> &
+vl_string<StaticCapacity, Allocator>::append
+    (const vl_string_concat<Lhs, Rhs> &expr)
 {
-  return *this + vl_string<StaticCapacity> (str);
+  bool from_self = expr.overlaps (data (), data () + size ());
+  append_with (expr.size (), from_self, [&expr] (char *dest)
+  { expr.copy_to (dest); });
+  return *this;
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity>
-vl_string<StaticCapacity>::operator+ (const char single_char) const
+/**
+ * appends len chars that write puts in place. the heap array grows by the
+ * growth policy when they don't fit - in place if the allocator can, unless
+ * the chars come from the array itself, which then stays alive until write
+ * is done with it
+ * @tparam StaticCapacity template capacity
+ * @tparam Allocator where the heap array comes from
+ * @tparam Writer a callable that writes len chars to the char * it gets
+ * @param len the number of chars
+ * @param from_self if the chars are read from this string
+ * @param write the writer
+ */
+template<size_t StaticCapacity, class Allocator>
+template<class Writer>
+void
+vl_string<StaticCapacity, Allocator>::append_with
+    (size_t len, bool from_self, Writer write)
 {
-  vl_string<StaticCapacity> ret_val = *this;
-  ret_val += single_char;
-  return ret_val;
+  size_t old_size = size ();
+  trace (vl_trace_insert, old_size, len);
+  if (old_size + len <= capacity ())
+    write (data () + old_size);
+  else
+    {
+      size_t new_cap = cap_func (len);
+      if (!from_self && resize_heap (new_cap))
+        write (data () + old_size);
+      else
+        {
+          char *new_arr = allocate (new_cap);
+          std::memcpy (new_arr, data (), old_size);
+          write (new_arr + old_size);
+          adopt_heap (new_arr, new_cap);
+        }
+    }
+  set_size (old_size + len);
 }
 
-template<size_t StaticCapacity>
-vl_string<StaticCapacity>::operator const char * () const
+/**
+ * the pieces of a vl_string_concat. they point at the chars of the operands,
+ * so a concatenation must be used (turned into a vl_string, appended) before
+ * the strings it was made of change or die - in one full expression, like
+ * vl_string<> msg = head + ": " + body + '\n';
+ */
+
+/** a run of chars - a vl_string, or a c string that is measured once */
+struct vl_chars_piece {
+  const char *str;
+  size_t len;
+
+  size_t size () const
+  { return len; }
+  char *copy_to (char *dest) const
+  {
+    std::memcpy (dest, str, len);
+    return dest + len;
+  }
+  /** tells if the chars are in [first, last) */
+  bool overlaps (const char *first, const char *last) const
+  {
+    std::less<const char *> before;
+    return before (str, last) && before (first, str + len);
+  }
+};
+
+/** a single char */
+struct vl_char_piece {
+  char single_char;
+
+  size_t size () const
+  { return 1; }
+  char *copy_to (char *dest) const
+  {
+    *dest = single_char;
+    return dest + 1;
+  }
+  bool overlaps (const char *, const char *) const
+  { return false; }
+};
+
+template<size_t StaticCapacity, class Allocator>
+vl_chars_piece vl_make_piece (const vl_string<StaticCapacity, Allocator> &str)
+{ return {str.data (), str.size ()}; }
+inline vl_chars_piece vl_make_piece (const char *str)
+{ return {str, std::strlen (str)}; }
+inline vl_chars_piece vl_make_piece (std::string_view str)
+{ return {str.data (), str.size ()}; }
+inline vl_char_piece vl_make_piece (char single_char)
+{ return {single_char}; }
+template<class Lhs, class Rhs>
+const vl_string_concat<Lhs, Rhs> &
+vl_make_piece (const vl_string_concat<Lhs, Rhs> &expr)
+{ return expr; }
+
+/** the piece an operand of + is kept as */
+template<class T>
+using vl_piece_t = typename std::decay<decltype (
+    vl_make_piece (std::declval<const T &> ()))>::type;
+
+/**
+ * a + b + ... of vl_strings, c strings and chars, before it is turned into a
+ * string. the total length is summed up front, so making the string takes one
+ * allocation and copies every piece once
+ * @tparam Lhs the piece on the left
+ * @tparam Rhs the piece on the right
+ */
+template<class Lhs, class Rhs>
+class vl_string_concat {
+ public:
+  vl_string_concat (const Lhs &lhs, const Rhs &rhs)
+      : _lhs (lhs), _rhs (rhs), _size (lhs.size () + rhs.size ())
+  {}
+
+  /** the number of chars in the concatenation */
+  size_t size () const
+  { return _size; }
+  /** copies all the chars to dest, returns the end of what was written */
+  char *copy_to (char *dest) const
+  { return _rhs.copy_to (_lhs.copy_to (dest)); }
+  /** tells if any piece is in [first, last) */
+  bool overlaps (const char *first, const char *last) const
+  { return _lhs.overlaps (first, last) || _rhs.overlaps (first, last); }
+
+  /** the concatenation as a string */
+  template<size_t StaticCapacity, class Allocator>
+  operator vl_string<StaticCapacity, Allocator> () const
+  {
+    vl_string<StaticCapacity, Allocator> str;
+    str.reserve (_size);
+    str.append (*this);
+    return str;
+  }
+
+ private:
+  Lhs _lhs;
+  Rhs _rhs;
+  size_t _size;
+};
+
+/** concatenation operators - they build a vl_string_concat */
+template<size_t StaticCapacity, class Allocator, class Rhs>
+vl_string_concat<vl_chars_piece, vl_piece_t<Rhs>>
+operator+ (const vl_string<StaticCapacity, Allocator> &lhs, const Rhs &rhs)
+{ return {vl_make_piece (lhs), vl_make_piece (rhs)}; }
+
+template<size_t StaticCapacity, class Allocator>
+vl_string_concat<vl_chars_piece, vl_chars_piece>
+operator+ (const char *lhs, const vl_string<StaticCapacity, Allocator> &rhs)
+{ return {vl_make_piece (lhs), vl_make_piece (rhs)}; }
+
+template<size_t StaticCapacity, class Allocator>
+vl_string_concat<vl_char_piece, vl_chars_piece>
+operator+ (char lhs, const vl_string<StaticCapacity, Allocator> &rhs)
+{ return {vl_make_piece (lhs), vl_make_piece (rhs)}; }
+
+template<class Lhs, class Rhs, class Next>
+vl_string_concat<vl_string_concat<Lhs, Rhs>, vl_piece_t<Next>>
+operator+ (const vl_string_concat<Lhs, Rhs> &lhs, const Next &rhs)
+{ return {lhs, vl_make_piece (rhs)}; }
+
+template<class Lhs, class Rhs>
+vl_string_concat<vl_chars_piece, vl_string_concat<Lhs, Rhs>>
+operator+ (const char *lhs, const vl_string_concat<Lhs, Rhs> &rhs)
+{ return {vl_make_piece (lhs), rhs}; }
+
+template<class Lhs, class Rhs>
+vl_string_concat<vl_char_piece, vl_string_concat<Lhs, Rhs>>
+operator+ (char lhs, const vl_string_concat<Lhs, Rhs> &rhs)
+{ return {vl_make_piece (lhs), rhs}; }
+
+/** comparison with a concatenation */
+template<size_t StaticCapacity, class Allocator, class Lhs, class Rhs>
+bool operator== (const vl_string<StaticCapacity, Allocator> &str,
+                 const vl_string_concat<Lhs, Rhs> &expr)
+{ return str == vl_string<StaticCapacity, Allocator> (expr); }
+template<size_t StaticCapacity, class Allocator, class Lhs, class Rhs>
+bool operator== (const vl_string_concat<Lhs, Rhs> &expr,
+                 const vl_string<StaticCapacity, Allocator> &str)
+{ return str == expr; }
+template<size_t StaticCapacity, class Allocator, class Lhs, class Rhs>
+bool operator!= (const vl_string<StaticCapacity, Allocator> &str,
+                 const vl_string_concat<Lhs, Rhs> &expr)
+{ return !(str == expr); }
+template<size_t StaticCapacity, class Allocator, class Lhs, class Rhs>
+bool operator!= (const vl_string_concat<Lhs, Rhs> &expr,
+                 const vl_string<StaticCapacity, Allocator> &str)
+{ return !(str == expr); }
+
+/** prints a concatenation */
+template<class Lhs, class Rhs>
+std::ostream &operator<< (std::ostream &os,
+                          const vl_string_concat<Lhs, Rhs> &expr)
+{ return os << static_cast<const char *> (vl_string<> (expr)); }
+
+/**
+ * builds a string out of many fragments. the chars go straight into the
+ * string that build hands over, so there is no copy at the end - reserve
+ * the expected length and the whole build allocates once
+ * @tparam StaticCapacity the static capacity of the built string
+ * @tparam Allocator where the heap array comes from
+ */
+template<size_t StaticCapacity = DEF_STATIC_CAP,
+    class Allocator = std::allocator<char>>
+class vl_string_builder {
+ public:
+  typedef vl_string<StaticCapacity, Allocator> string_type;
+
+  vl_string_builder () = default;
+  explicit vl_string_builder (const Allocator &alloc) : _str (alloc)
+  {}
+
+  /** makes room for len chars in all */
+  vl_string_builder &reserve (size_t len)
+  {
+    _str.reserve (len);
+    return *this;
+  }
+
+  /** append functions */
+  vl_string_builder &append (const char *str, size_t len)
+  {
+    _str.append (str, len);
+    return *this;
+  }
+  vl_string_builder &append (const char *str)
+  { return append (str, std::strlen (str)); }
+  vl_string_builder &append (char single_char)
+  { return append (&single_char, 1); }
+  vl_string_builder &append (std::string_view str)
+  { return append (str.data (), str.size ()); }
+  template<size_t OtherCapacity, class OtherAllocator>
+  vl_string_builder &
+  append (const vl_string<OtherCapacity, OtherAllocator> &str)
+  { return append (str.data (), str.size ()); }
+  template<class Lhs, class Rhs>
+  vl_string_builder &append (const vl_string_concat<Lhs, Rhs> &expr)
+  {
+    _str.append (expr);
+    return *this;
+  }
+  /** appends printf style formatted text */
+  vl_string_builder &append_format (const char *format, ...)
+  __attribute__ ((format (printf, 2, 3)));
+
+  /** the number of chars so far */
+  size_t size () const
+  { return _str.size (); }
+  /** the chars so far, null terminated */
+  const char *data () const
+  { return _str.c_str (); }
+
+  /** hands over the built string, the builder is left empty */
+  string_type build ()
+  { return std::move (_str); }
+
+ private:
+  string_type _str;
+};
+
+/**
+ * appends printf style formatted text, straight into the string's spare
+ * capacity. only text that doesn't fit is formatted twice
+ * @tparam StaticCapacity the static capacity of the built string
+ * @tparam Allocator where the heap array comes from
+ * @param format the printf format
+ * @return this builder
+ */
+template<size_t StaticCapacity, class Allocator>
+vl_string_builder<StaticCapacity, Allocator> &
+vl_string_builder<StaticCapacity, Allocator>::append_format
+    (const char *format, ...)
 {
-  return this->data ();
+  size_t old_size = _str.size ();
+  // the room left, counting the place of the null terminator
+  size_t room = _str.capacity () - old_size + 1;
+  va_list args;
+  va_start (args, format);
+  va_list retry;
+  va_copy (retry, args);
+  int len = std::vsnprintf (_str.data () + old_size, room, format, args);
+  va_end (args);
+  // the terminator may have landed on the free chars count of a full string
+  _str.set_size (old_size);
+  if (len > 0 && static_cast<size_t> (len) >= room)
+    {
+      _str.grow_by (len);
+      std::vsnprintf (_str.data () + old_size, len + 1, format, retry);
+    }
+  va_end (retry);
+  if (len > 0)
+    _str.set_size (old_size + len);
+  return *this;
+}
+
+/**
+ * a vl_string that keeps its hash once it is computed, for keys that are
+ * looked up many times - a probe of a hash table with the same key hashes it
+ * once. the members that change the chars drop the cached hash, and they are
+ * the only way to change them: the chars are read only otherwise, and edit
+ * hands out the string itself after dropping it
+ * @tparam StaticCapacity the minimum number of inline chars
+ * @tparam Allocator where the heap array comes from
+ */
+template<size_t StaticCapacity = DEF_STATIC_CAP,
+    class Allocator = std::allocator<char>>
+class vl_hashed_string {
+ public:
+  typedef vl_string<StaticCapacity, Allocator> string_type;
+
+  vl_hashed_string () = default;
+  vl_hashed_string (const char *str) : _str (str)
+  {}
+  explicit vl_hashed_string (std::string_view str) : _str (str)
+  {}
+  explicit vl_hashed_string (string_type str) : _str (std::move (str))
+  {}
+  vl_hashed_string (const vl_hashed_string &other) = default;
+  /** move ctr - the moved from string is left empty, without a hash */
+  vl_hashed_string (vl_hashed_string &&other) noexcept
+      : _str (std::move (other._str)), _hash (other._hash)
+  { other._hash = 0; }
+  vl_hashed_string &operator= (const vl_hashed_string &other) = default;
+  vl_hashed_string &operator= (vl_hashed_string &&other) noexcept
+  {
+    _str = std::move (other._str);
+    _hash = other._hash;
+    other._hash = 0;
+    return *this;
+  }
+
+  /** the hash of the chars, computed on the first call after a change */
+  size_t hash () const
+  {
+    if (_hash == 0)
+      _hash = vl_hash_bytes (_str.data (), _str.size ());
+    return _hash;
+  }
+
+  /** read access */
+  const string_type &str () const
+  { return _str; }
+  std::string_view sv () const
+  { return _str.sv (); }
+  const char *c_str () const
+  { return _str.c_str (); }
+  const char *data () const
+  { return _str.data (); }
+  size_t size () const
+  { return _str.size (); }
+  bool empty () const
+  { return _str.empty (); }
+  char operator[] (size_t index) const
+  { return _str[index]; }
+  const char *begin () const
+  { return _str.begin (); }
+  const char *end () const
+  { return _str.end (); }
+
+  /** changes - each drops the cached hash */
+  vl_hashed_string &operator= (std::string_view str)
+  {
+    edit () = string_type (str);
+    return *this;
+  }
+  vl_hashed_string &operator= (const char *str)
+  { return *this = std::string_view (str); }
+  vl_hashed_string &operator+= (std::string_view str)
+  {
+    edit () += str;
+    return *this;
+  }
+  vl_hashed_string &operator+= (char single_char)
+  {
+    edit () += single_char;
+    return *this;
+  }
+  void push_back (char single_char)
+  { edit ().push_back (single_char); }
+  void pop_back ()
+  { edit ().pop_back (); }
+  void clear ()
+  { edit ().clear (); }
+  void resize (size_t len, char fill = '\0')
+  { edit ().resize (len, fill); }
+  /** the string to change in any other way. the hash is dropped now, so
+   * the reference must not be used after the next hash () */
+  string_type &edit ()
+  {
+    _hash = 0;
+    return _str;
+  }
+
+  /** comp operators - strings with different cached hashes differ */
+  friend bool operator== (const vl_hashed_string &lhs,
+                          const vl_hashed_string &rhs)
+  {
+    if (lhs._hash != 0 && rhs._hash != 0 && lhs._hash != rhs._hash)
+      return false;
+    return lhs.sv () == rhs.sv ();
+  }
+  friend bool operator!= (const vl_hashed_string &lhs,
+                          const vl_hashed_string &rhs)
+  { return !(lhs == rhs); }
+  friend bool operator< (const vl_hashed_string &lhs,
+                         const vl_hashed_string &rhs)
+  { return lhs.sv () < rhs.sv (); }
+
+ private:
+  string_type _str;
+  mutable size_t _hash = 0; // 0 - not computed yet
+};
+
+/**
+ * the chars of any string type as a view - what the transparent functors
+ * below compare and hash, so a vl_string key can be looked up with a
+ * const char *, a std::string_view or a std::string without building one
+ */
+inline std::string_view vl_sv (std::string_view str)
+{ return str; }
+inline std::string_view vl_sv (const char *str)
+{ return str; }
+template<size_t StaticCapacity, class Allocator>
+std::string_view vl_sv (const vl_string<StaticCapacity, Allocator> &str)
+{ return str.sv (); }
+template<size_t StaticCapacity, class Allocator>
+std::string_view
+vl_sv (const vl_hashed_string<StaticCapacity, Allocator> &str)
+{ return str.sv (); }
+
+/**
+ * transparent hash of strings - the same value for equal chars of any string
+ * type, the cached one for a vl_hashed_string. with vl_string_equal it lets
+ * hash tables that support transparent lookup (C++20 std::unordered_map,
+ * absl / boost flat maps) find a vl_string key by a view
+ */
+struct vl_string_hash {
+  typedef void is_transparent;
+
+  template<class String>
+  size_t operator() (const String &str) const
+  {
+    std::string_view chars = vl_sv (str);
+    return vl_hash_bytes (chars.data (), chars.size ());
+  }
+  template<size_t StaticCapacity, class Allocator>
+  size_t
+  operator() (const vl_hashed_string<StaticCapacity, Allocator> &str) const
+  { return str.hash (); }
+};
+/** transparent equality of strings */
+struct vl_string_equal {
+  typedef void is_transparent;
+
+  template<class Lhs, class Rhs>
+  bool operator() (const Lhs &lhs, const Rhs &rhs) const
+  { return vl_sv (lhs) == vl_sv (rhs); }
+};
+/** transparent ordering of strings - std::map / std::set find a vl_string
+ * key by a view with it already in C++17 */
+struct vl_string_less {
+  typedef void is_transparent;
+
+  template<class Lhs, class Rhs>
+  bool operator() (const Lhs &lhs, const Rhs &rhs) const
+  { return vl_sv (lhs) < vl_sv (rhs); }
+};
+
+/** std::hash of the strings - the vl_string_hash value */
+namespace std {
+template<size_t StaticCapacity, class Allocator>
+struct hash<vl_string<StaticCapacity, Allocator>> {
+  size_t operator() (const vl_string<StaticCapacity, Allocator> &str) const
+  { return vl_hash_bytes (str.data (), str.size ()); }
+};
+template<size_t StaticCapacity, class Allocator>
+struct hash<vl_hashed_string<StaticCapacity, Allocator>> {
+  size_t
+  operator() (const vl_hashed_string<StaticCapacity, Allocator> &str) const
+  { return str.hash (); }
+};
 }
 
 #endif //_VL_STRING_H_
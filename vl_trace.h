@@ -0,0 +1,253 @@
+#ifndef _VL_TRACE_H_
+#define _VL_TRACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * workload traces of vl_vector, for picking StaticCapacity by replaying them
+ * (bench/vl_capacity_advisor.cpp). with VL_ENABLE_TRACE defined for the whole
+ * program, every vl_vector (and vl_string) instantiation - a site - records
+ * the size changing ops of each of its vectors, and the trace is written at
+ * exit to the file
+ * named by the VL_TRACE_OUT env var (vl_trace.txt if it is not set).
+ * without VL_ENABLE_TRACE the hook is an empty inline function.
+ *
+ * the trace is text - a header line, a line per site:
+ *   site <site> <static capacity> <elem size> <type name>
+ * and a line per op:
+ *   <site> <object> <op> <pos> <count>
+ * objects are numbered per site in the order they are first seen, a vector
+ * first seen with elems (a copy) starts with a new op of its size
+ */
+
+/** the ops of a trace */
+enum vl_trace_op : char {
+  vl_trace_new = 'n',     // count - the size the vector is first seen with
+  vl_trace_push = 'p',    // one elem appended
+  vl_trace_insert = 'i',  // count elems inserted at pos
+  vl_trace_erase = 'e',   // count elems erased from pos
+  vl_trace_pop = 'o',     // the last elem removed
+  vl_trace_resize = 'r',  // resized to count
+  vl_trace_reserve = 'v', // reserve (count)
+  vl_trace_shrink = 'f',  // shrink_to_fit
+  vl_trace_release = 'l', // emptied, the heap array freed
+  vl_trace_take = 't',    // took the elems of object pos, leaving it empty
+  vl_trace_swap = 's',    // swapped with object pos
+  vl_trace_destroy = 'd'  // the vector died
+};
+
+/** an op on one vector */
+struct vl_trace_record {
+  uint32_t object;
+  vl_trace_op op;
+  uint64_t pos;
+  uint64_t count;
+};
+
+/** the trace of one vl_vector instantiation */
+struct vl_trace_site {
+  std::string name;
+  size_t static_capacity;
+  size_t elem_size;
+  std::vector<vl_trace_record> records;
+};
+
+/** the first line of a trace */
+constexpr const char *vl_trace_magic = "vl_trace 1";
+
+/** writes the sites as a trace */
+inline void vl_trace_write (std::ostream &os,
+                            const std::vector<vl_trace_site> &sites)
+{
+  os << vl_trace_magic << "\n";
+  for (size_t site = 0; site < sites.size (); ++site)
+    os << "site " << site << " " << sites[site].static_capacity << " "
+       << sites[site].elem_size << " " << sites[site].name << "\n";
+  for (size_t site = 0; site < sites.size (); ++site)
+    for (const vl_trace_record &record : sites[site].records)
+      os << site << " " << record.object << " " << char (record.op) << " "
+         << record.pos << " " << record.count << "\n";
+}
+
+/** tells if op is one of the trace ops */
+inline bool vl_trace_valid_op (char op)
+{
+  return op != '\0' && std::strchr ("npieorvflstd", op) != nullptr;
+}
+
+/**
+ * reads a trace written by vl_trace_write. throws runtime error if it is not
+ * one
+ */
+inline std::vector<vl_trace_site> vl_trace_read (std::istream &is)
+{
+  std::string line;
+  if (!std::getline (is, line) || line != vl_trace_magic)
+    throw std::runtime_error ("Not a vl_trace");
+  std::vector<vl_trace_site> sites;
+  for (size_t line_no = 2; std::getline (is, line); ++line_no)
+    {
+      if (line.empty ())
+        continue;
+      std::istringstream fields (line);
+      bool ok;
+      if (line.compare (0, 5, "site ") == 0)
+        {
+          std::string word;
+          size_t index;
+          vl_trace_site site;
+          ok = bool (fields >> word >> index >> site.static_capacity
+                            >> site.elem_size >> std::ws)
+               && index == sites.size ();
+          std::getline (fields, site.name);
+          sites.push_back (std::move (site));
+        }
+      else
+        {
+          size_t site;
+          char op;
+          vl_trace_record record;
+          ok = bool (fields >> site >> record.object >> op >> record.pos
+                            >> record.count)
+               && site < sites.size () && vl_trace_valid_op (op);
+          if (ok)
+            {
+              record.op = vl_trace_op (op);
+              sites[site].records.push_back (record);
+            }
+        }
+      if (!ok)
+        throw std::runtime_error ("Bad Trace Line "
+                                  + std::to_string (line_no));
+    }
+  return sites;
+}
+
+#ifdef VL_ENABLE_TRACE
+
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+
+/** the traces recorded so far, written at exit */
+class vl_trace_recorder {
+ public:
+  static vl_trace_recorder &instance ()
+  { // never destroyed, vectors may die after the trace is written
+    static vl_trace_recorder *recorder = new vl_trace_recorder;
+    return *recorder;
+  }
+
+  /** adds a site, returns its index */
+  size_t add_site (const std::type_info &type, size_t static_capacity,
+                   size_t elem_size)
+  {
+    int status = 0;
+    std::unique_ptr<char, void (*) (void *)> demangled (
+        abi::__cxa_demangle (type.name (), nullptr, nullptr, &status),
+        std::free);
+    std::lock_guard<std::mutex> lock (_mutex);
+    if (_sites.empty ())
+      std::atexit (write_at_exit);
+    _sites.push_back ({{status == 0 ? demangled.get () : type.name (),
+                        static_capacity, elem_size, {}}, {}, 0});
+    return _sites.size () - 1;
+  }
+
+  /**
+   * records an op of the vector at object, that has size elems. a vector not
+   * seen yet gets a new op first - so does source, the other vector of a take
+   * or a swap, with source_size elems
+   */
+  void record (size_t site, const void *object, size_t size, vl_trace_op op,
+               size_t pos, size_t count, const void *source,
+               size_t source_size)
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    recording &rec = _sites[site];
+    uint32_t id = object_id (rec, object, size);
+    if (source != nullptr)
+      pos = object_id (rec, source, source_size);
+    rec.site.records.push_back ({id, op, pos, count});
+    if (op == vl_trace_destroy)
+      rec.live.erase (object);
+  }
+
+  /** a copy of the traces so far */
+  std::vector<vl_trace_site> sites ()
+  {
+    std::lock_guard<std::mutex> lock (_mutex);
+    std::vector<vl_trace_site> sites;
+    for (const recording &rec : _sites)
+      sites.push_back (rec.site);
+    return sites;
+  }
+
+ private:
+  struct recording {
+    vl_trace_site site;
+    std::unordered_map<const void *, uint32_t> live; // object ids by address
+    uint32_t next_id;
+  };
+
+  static uint32_t object_id (recording &rec, const void *object, size_t size)
+  {
+    auto found = rec.live.find (object);
+    if (found != rec.live.end ())
+      return found->second;
+    uint32_t id = rec.next_id++;
+    rec.live.emplace (object, id);
+    rec.site.records.push_back ({id, vl_trace_new, 0, size});
+    return id;
+  }
+
+  static void write_at_exit ()
+  {
+    const char *path = std::getenv ("VL_TRACE_OUT");
+    std::ofstream out (path != nullptr ? path : "vl_trace.txt");
+    vl_trace_write (out, instance ().sites ());
+  }
+
+  std::mutex _mutex;
+  std::vector<recording> _sites;
+};
+
+/**
+ * records an op of the vector at object, that has size elems before it
+ * @tparam Container the vl_vector type
+ * @param source the other vector of a take / swap, its number goes to pos
+ * @param source_size the size of source
+ */
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_trace (const void *object, size_t size, vl_trace_op op,
+                      size_t pos = 0, size_t count = 0,
+                      const void *source = nullptr, size_t source_size = 0)
+{
+  static size_t site = vl_trace_recorder::instance ()
+      .add_site (typeid (Container), StaticCapacity, ElemSize);
+  vl_trace_recorder::instance ().record (site, object, size, op, pos, count,
+                                         source, source_size);
+}
+
+#else
+
+template<class Container, size_t StaticCapacity, size_t ElemSize>
+inline void vl_trace (const void *, size_t, vl_trace_op, size_t = 0,
+                      size_t = 0, const void * = nullptr, size_t = 0)
+{}
+
+#endif //VL_ENABLE_TRACE
+
+#endif //_VL_TRACE_H_
@@ -1,67 +1,321 @@
-
 #ifndef _VL_VECTOR_H_
 #define _VL_VECTOR_H_
 #define DEF_STATIC_CAP 16
+#include "vl_hash.h"
+#include "vl_simd.h"
+#include "vl_span.h"
+#include "vl_stats.h"
+#include "vl_trace.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * tells if a T can be moved to a new address by copying its bytes, leaving
+ * nothing alive to destroy in the old address. true for trivially copyable
+ * types, specialize it to std::true_type to opt in other types (e.g. types
+ * that only hold a pointer to a heap allocation)
+ * @tparam T the type to check
+ */
+template<typename T>
+struct vl_is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+/**
+ * moves the elems in [first, last) to the raw memory in dest and destroys
+ * them in the old place. the ranges must not overlap
+ * @tparam T the elems type
+ * @param first the first elem to move
+ * @param last one past the last elem to move
+ * @param dest raw memory for last - first elems
+ */
+template<typename T>
+void vl_relocate (T *first, T *last, T *dest)
+{
+  if constexpr (vl_is_trivially_relocatable<T>::value)
+    {
+      if (first != last)
+        std::memcpy (static_cast<void *> (dest),
+                     static_cast<const void *> (first),
+                     (last - first) * sizeof (T));
+    }
+  else
+    {
+      std::uninitialized_move (first, last, dest);
+      for (; first != last; ++first)
+        first->~T ();
+    }
+}
+/**
+ * builds the elems of [first, last) in the raw memory in dest, the way
+ * std::move_if_noexcept picks - moved if T's move ctor can't throw or T
+ * can't be copied, copied otherwise - and leaves the sources for the caller
+ * to destroy. so if building one throws, the ones built are destroyed and
+ * the sources are as they were, unless a throwing move was the only way
+ * @tparam T the elems type
+ * @param first the first elem to move
+ * @param last one past the last elem to move
+ * @param dest raw memory for last - first elems
+ */
+template<typename T>
+void vl_uninitialized_move_if_noexcept (T *first, T *last, T *dest)
+{
+  if constexpr (std::is_nothrow_move_constructible<T>::value
+                || !std::is_copy_constructible<T>::value)
+    std::uninitialized_move (first, last, dest);
+  else
+    std::uninitialized_copy (first, last, dest);
+}
+/**
+ * same as vl_relocate, but the ranges may overlap. only for trivially
+ * relocatable types, used to open or close gaps inside an array
+ * @tparam T the elems type
+ * @param first the first elem to move
+ * @param last one past the last elem to move
+ * @param dest where the first elem goes to
+ */
+template<typename T>
+void vl_relocate_overlapping (T *first, T *last, T *dest)
+{
+  static_assert (vl_is_trivially_relocatable<T>::value,
+                 "vl_relocate_overlapping needs a trivially relocatable T");
+  if (first != last)
+    std::memmove (static_cast<void *> (dest),
+                  static_cast<const void *> (first),
+                  (last - first) * sizeof (T));
+}
+
+/**
+ * shrink policies - decide when a vector that lives on the heap gives the
+ * heap array back. should_shrink is asked after every pop_back / erase, and
+ * explicit_shrink tells if shrink_to_fit does anything
+ */
+
+/** back to the static array as soon as the elems fit in it */
+struct vl_shrink_eager {
+  static bool should_shrink (size_t size, size_t, size_t static_cap)
+  { return size <= static_cap; }
+  static constexpr bool explicit_shrink = true;
+};
+/** the capacity never goes down, shrink_to_fit does nothing */
+struct vl_shrink_never {
+  static bool should_shrink (size_t, size_t, size_t)
+  { return false; }
+  static constexpr bool explicit_shrink = false;
+};
+/**
+ * shrinks only when the elems use 1 / Divisor of the heap array or less, so
+ * a size that goes up and down around the static capacity does not move
+ * the elems back and forth on every push / pop
+ */
+template<size_t Divisor = 4>
+struct vl_shrink_hysteresis {
+  static_assert (Divisor >= 2, "the hysteresis divisor must be at least 2");
+  static bool should_shrink (size_t size, size_t dynamic_cap, size_t)
+  { return size <= dynamic_cap / Divisor; }
+  static constexpr bool explicit_shrink = true;
+};
+/** shrinks only on an explicit shrink_to_fit */
+struct vl_shrink_explicit {
+  static bool should_shrink (size_t, size_t, size_t)
+  { return false; }
+  static constexpr bool explicit_shrink = true;
+};
+
+/**
+ * growth policies - give the capacity of a new heap array that must hold at
+ * least needed elems of elem_size bytes each
+ */
+
+/** 1.5 times the needed size, the formula in ex6 def file */
+struct vl_growth_1_5x {
+  static size_t capacity (size_t needed, size_t)
+  { return 3 * needed / 2; }
+};
+/** twice the needed size */
+struct vl_growth_2x {
+  static size_t capacity (size_t needed, size_t)
+  { return 2 * needed; }
+};
+/** the smallest power of two that is not below the needed size */
+struct vl_growth_pow2 {
+  static size_t capacity (size_t needed, size_t)
+  {
+    size_t cap = 1;
+    while (cap < needed)
+      cap <<= 1;
+    return cap;
+  }
+};
+/**
+ * 1.5 times the needed size, rounded up so the array takes whole pages. big
+ * arrays then waste no tail of a page, and page granular allocators (mmap,
+ * huge pages) can often grow them in place
+ */
+template<size_t PageSize = 4096>
+struct vl_growth_page {
+  static size_t capacity (size_t needed, size_t elem_size)
+  {
+    size_t bytes = 3 * needed / 2 * elem_size;
+    bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+    size_t cap = bytes / elem_size;
+    return cap < needed ? needed : cap;
+  }
+};
+/** exactly the needed size */
+struct vl_growth_exact {
+  static size_t capacity (size_t needed, size_t)
+  { return needed; }
+};
+
+/**
+ * tells if an allocator can grow an array in place -
+ * bool try_expand (T *arr, size_t old_cap, size_t new_cap) returns true if
+ * arr now holds new_cap elems, without moving it
+ */
+template<class Alloc, class = void>
+struct vl_has_try_expand : std::false_type {};
+template<class Alloc>
+struct vl_has_try_expand<Alloc, std::void_t<decltype (
+    std::declval<Alloc &> ().try_expand (
+        std::declval<typename Alloc::value_type *> (), size_t (),
+        size_t ()))>> : std::true_type {};
+/**
+ * tells if an allocator can resize an array realloc style -
+ * T *reallocate (T *arr, size_t old_cap, size_t new_cap) may move the bytes
+ * of the array to a new address, so it is used only for trivially
+ * relocatable types
+ */
+template<class Alloc, class = void>
+struct vl_has_reallocate : std::false_type {};
+template<class Alloc>
+struct vl_has_reallocate<Alloc, std::void_t<decltype (
+    std::declval<Alloc &> ().reallocate (
+        std::declval<typename Alloc::value_type *> (), size_t (),
+        size_t ()))>> : std::true_type {};
+
+template<typename T, size_t StaticCapacity = DEF_STATIC_CAP,
+    class ShrinkPolicy = vl_shrink_hysteresis<>,
+    class GrowthPolicy = vl_growth_1_5x,
+    class Allocator = std::allocator<T>>
+class vl_vector : private Allocator {
 
-template<typename T, size_t StaticCapacity = DEF_STATIC_CAP>
-class vl_vector {
+  typedef std::allocator_traits<Allocator> alloc_traits;
+  static_assert (std::is_same<typename alloc_traits::value_type, T>::value,
+                 "the allocator must allocate T");
+  static_assert (std::is_same<typename alloc_traits::pointer, T *>::value,
+                 "the allocator must use raw pointers");
 
  public:
 
+  typedef T value_type;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef T *pointer;
+  typedef const T *const_pointer;
+  typedef Allocator allocator_type;
+
   /** def ctr */
-  vl_vector () : _size (0), _dynamic_cap (0), _dynamic_arr_p (nullptr),
-                 _static_capacity (StaticCapacity)
+  vl_vector () : _size (0), _arr_p (static_arr ())
+  {}
+  /** empty vector that takes its heap memory from alloc */
+  explicit vl_vector (const Allocator &alloc)
+      : Allocator (alloc), _size (0),
+        _arr_p (static_arr ())
   {}
   /** cpy ctr */
-  vl_vector (const vl_vector<T, StaticCapacity> &other_vec)
-      : _size (other_vec._size), _dynamic_cap (other_vec._dynamic_cap),
-        _static_capacity (other_vec._static_capacity)
+  vl_vector (const vl_vector &other_vec)
+      : vl_vector (other_vec, alloc_traits::
+      select_on_container_copy_construction (other_vec.get_allocator ()))
+  {}
+  /**
+   * cpy ctr that takes its heap memory from alloc. the copy is sized for
+   * other_vec's elems, not its capacity - a shrunk heap vector whose elems
+   * fit the static array is copied into it
+   */
+  vl_vector (const vl_vector &other_vec, const Allocator &alloc)
+      : Allocator (alloc), _size (0),
+        _arr_p (static_arr ())
   {
-    if (other_vec._dynamic_arr_p != nullptr)
+    if (other_vec._size > StaticCapacity)
       {
-        _dynamic_arr_p = new T[_dynamic_cap];
-        for (size_t i = 0; i < other_vec._size; ++i)
-          _dynamic_arr_p[i] = other_vec._dynamic_arr_p[i];
+        _dynamic_cap = cap_func (other_vec._size);
+        _arr_p = allocate (_dynamic_cap);
       }
-    else
+    try
+      {
+        std::uninitialized_copy (other_vec.begin (), other_vec.end (),
+                                 data ());
+      }
+    catch (...)
       {
-        for (size_t i = 0; i < other_vec._size; ++i)
-          _static_arr[i] = other_vec._static_arr[i];
-        _dynamic_arr_p = nullptr;
+        free_heap ();
+        throw;
       }
+    _size = other_vec._size;
+    stat (vl_stat_copy, _size);
+  }
+  /** move ctr - steals the heap array, or moves the static elems one by one */
+  vl_vector (vl_vector &&other_vec)
+  noexcept (std::is_nothrow_move_constructible<T>::value)
+      : Allocator (std::move (other_vec.alloc ())), _size (other_vec._size),
+        _arr_p (static_arr ())
+  {
+    vl_trace<vl_vector, StaticCapacity, sizeof (T)> (
+        this, 0, vl_trace_take, 0, 0, &other_vec, other_vec._size);
+    if (other_vec.on_heap ())
+      {
+        _arr_p = other_vec._arr_p;
+        _dynamic_cap = other_vec._dynamic_cap;
+      }
+    else
+      vl_relocate (other_vec.begin (), other_vec.end (), _arr_p);
+    other_vec._size = 0;
+    other_vec._arr_p = other_vec.static_arr ();
   }
   /** sequence based ctr - construct the vector and adds all the sequence of elems */
   template<class ForwardIterator>
-  vl_vector (ForwardIterator first, ForwardIterator last)
-      : _size (0), _dynamic_cap (0), _dynamic_arr_p (nullptr),
-        _static_capacity (StaticCapacity)
+  vl_vector (ForwardIterator first, ForwardIterator last,
+             const Allocator &alloc = Allocator ())
+      : Allocator (alloc), _size (0),
+        _arr_p (static_arr ())
   { insert (begin (), first, last); }
   /** Single-value init ctr */
-  vl_vector (size_t count, const T &elem) : _size (0),
-                                            _static_capacity (StaticCapacity)
+  vl_vector (size_t count, const T &elem, const Allocator &alloc = Allocator ())
+      : Allocator (alloc), _size (0),
+        _arr_p (static_arr ())
   {
-    if (count > _static_capacity)
+    if (count > StaticCapacity)
       {
-        size_t new_size = cap_func (count);
-        _dynamic_cap = new_size;
-        _dynamic_arr_p = new T[new_size];
-        for (size_t i = 0; i < count; ++i)
-          _dynamic_arr_p[i] = elem;
+        _dynamic_cap = cap_func (count);
+        _arr_p = allocate (_dynamic_cap);
       }
-    else
+    try
+      {
+        std::uninitialized_fill_n (data (), count, elem);
+      }
+    catch (...)
       {
-        for (size_t i = 0; i < count; ++i)
-          _static_arr[i] = elem;
-        _dynamic_arr_p = nullptr;
-        _dynamic_cap = 0;
+        free_heap ();
+        throw;
       }
     _size = count;
+    stat (vl_stat_copy, count);
+  }
+  /** destructor */
+  ~vl_vector ()
+  {
+    trace (vl_trace_destroy);
+    vl_stats_died<vl_vector, StaticCapacity, sizeof (T)> (_size);
+    destroy (begin (), end ());
+    free_heap ();
   }
-  /** destructor - virtual for the bonus VLString */
-  virtual ~vl_vector ()
-  { if (_dynamic_arr_p != nullptr) delete[] _dynamic_arr_p; }
 
   // iterators typedefs
   typedef T *iterator;
@@ -71,445 +325,1406 @@ class vl_vector {
 
   // definition of all iterators
   iterator begin ()
-  { return _dynamic_arr_p != nullptr ? _dynamic_arr_p : _static_arr; }
+  { return data (); }
   const_iterator begin () const
-  { return _dynamic_arr_p != nullptr ? _dynamic_arr_p : _static_arr; }
+  { return data (); }
   const_iterator cbegin () const
-  { return _dynamic_arr_p != nullptr ? _dynamic_arr_p : _static_arr; }
+  { return data (); }
   iterator end ()
-  {
-    return _dynamic_arr_p != nullptr ? _dynamic_arr_p + _size
-                                     : _static_arr + _size;
-  }
+  { return data () + _size; }
   const_iterator end () const
-  {
-    return _dynamic_arr_p != nullptr ? _dynamic_arr_p + _size
-                                     : _static_arr + _size;
-  }
+  { return data () + _size; }
   const_iterator cend () const
-  {
-    return _dynamic_arr_p != nullptr ? _dynamic_arr_p + _size
-                                     : _static_arr + _size;
-  }
+  { return data () + _size; }
   // all reverse iterators
-  virtual reverse_iterator rbegin ()
+  reverse_iterator rbegin ()
   { return std::reverse_iterator<iterator> (end ()); }
-  virtual const_reverse_iterator rbegin () const
+  const_reverse_iterator rbegin () const
   { return std::reverse_iterator<const_iterator> (end ()); }
-  virtual const_reverse_iterator crbegin () const
+  const_reverse_iterator crbegin () const
   { return std::reverse_iterator<const_iterator> (cend ()); }
-  virtual reverse_iterator rend ()
+  reverse_iterator rend ()
   { return std::reverse_iterator<iterator> (begin ()); }
-  virtual const_reverse_iterator rend () const
+  const_reverse_iterator rend () const
   { return std::reverse_iterator<const_iterator> (begin ()); }
-  virtual const_reverse_iterator crend () const
+  const_reverse_iterator crend () const
   { return std::reverse_iterator<const_iterator> (cbegin ()); }
 
-  virtual size_t size () const
+  size_t size () const
   { return _size; }
   size_t capacity () const
-  { return _dynamic_arr_p != nullptr ? _dynamic_cap : _static_capacity; }
+  { return on_heap () ? _dynamic_cap : StaticCapacity; }
   bool empty () const
   { return size () == 0; }
+  /** a copy of the allocator the heap array comes from */
+  Allocator get_allocator () const
+  { return alloc (); }
 
   /** All the declarations, implementations outside the class*/
   T &at (size_t index);
   T at (size_t index) const;
-  virtual void push_back (const T &elem);
+  void push_back (const T &elem);
+  void push_back (T &&elem);
+  template<class... Args>
+  T &emplace_back (Args &&... args);
   iterator insert (const_iterator position, const T &new_elem);
+  iterator insert (const_iterator position, T &&new_elem);
+  template<class... Args>
+  iterator emplace (const_iterator position, Args &&... args);
 
-  template<class ForwardIterator>
+  template<class InputIterator>
   iterator insert (const_iterator position,
-                   ForwardIterator first, ForwardIterator last);
-  virtual void pop_back ();
+                   InputIterator first, InputIterator last);
+  /** appends [first, last), the vector grows at most once for the range */
+  template<class InputIterator>
+  iterator append (InputIterator first, InputIterator last)
+  { return insert (cend (), first, last); }
+  /** replaces the elems with [first, last), which must not be in the vector */
+  template<class InputIterator>
+  void assign (InputIterator first, InputIterator last);
+  void resize (size_t new_size);
+  void resize (size_t new_size, const T &value);
+  void resize_for_overwrite (size_t new_size);
+  iterator append_uninitialized (size_t count);
+  void pop_back ();
   iterator erase (const_iterator elem_to_remove);
   iterator erase (const_iterator first, const_iterator last);
-  virtual void clear ();
+  void clear ();
   T *data ();
   const T *data () const;
-  virtual bool contains (const T &elem_to_check) const;
+  /** a view of the elems, valid until the vector grows, shrinks or dies */
+  vl_span<T> as_span ()
+  { return vl_span<T> (_arr_p, _size); }
+  vl_span<const T> as_span () const
+  { return vl_span<const T> (_arr_p, _size); }
+  bool contains (const T &elem_to_check) const;
+  /** the first elem equal to value, or end () */
+  iterator find (const T &value)
+  { return begin () + find_index (value); }
+  const_iterator find (const T &value) const
+  { return begin () + find_index (value); }
+  /** the first elem pred accepts, or end () */
+  template<class Predicate>
+  iterator find_if (Predicate pred)
+  { return std::find_if (begin (), end (), pred); }
+  template<class Predicate>
+  const_iterator find_if (Predicate pred) const
+  { return std::find_if (begin (), end (), pred); }
+  /** the number of elems equal to value */
+  size_t count (const T &value) const;
+  /** the number of elems pred accepts */
+  template<class Predicate>
+  size_t count_if (Predicate pred) const
+  { return std::count_if (begin (), end (), pred); }
+  void reserve (size_t new_cap);
+  void shrink_to_fit ();
+  void swap (vl_vector &other)
+  noexcept (std::is_nothrow_move_constructible<T>::value
+            && std::is_nothrow_swappable<T>::value
+            && (alloc_traits::propagate_on_container_swap::value
+                || alloc_traits::is_always_equal::value));
 
   /** cpy assignment ctr */
-  vl_vector<T, StaticCapacity> &
-  operator= (const vl_vector<T, StaticCapacity> &other);
+  vl_vector &
+  operator= (const vl_vector &other);
+  /** move assignment operator */
+  vl_vector &
+  operator= (vl_vector &&other)
+  noexcept (std::is_nothrow_move_constructible<T>::value
+            && (alloc_traits::propagate_on_container_move_assignment::value
+                || alloc_traits::is_always_equal::value));
   /** subscript operator */
   T &operator[] (size_t index)
-  {
-    return _dynamic_arr_p != nullptr ? _dynamic_arr_p[index]
-                                     : _static_arr[index];
-  }
+  { return data ()[index]; }
   /** const subscript operator */
   const T &operator[] (size_t index) const
-  {
-    return _dynamic_arr_p != nullptr ? _dynamic_arr_p[index]
-                                     : _static_arr[index];
-  }
+  { return data ()[index]; }
   /** comparison operator */
-  bool operator== (const vl_vector<T, StaticCapacity> &other_vec) const;
+  bool operator== (const vl_vector &other_vec) const;
   /** comparison operator */
-  bool operator!= (const vl_vector<T, StaticCapacity> &other_vec) const
+  bool operator!= (const vl_vector &other_vec) const
   { return !(*this == other_vec); }
+  /** ordering operators - lexicographic, memcmp for unsigned bytes */
+  bool operator< (const vl_vector &other_vec) const
+  { return compare (other_vec) < 0; }
+  bool operator<= (const vl_vector &other_vec) const
+  { return compare (other_vec) <= 0; }
+  bool operator> (const vl_vector &other_vec) const
+  { return compare (other_vec) > 0; }
+  bool operator>= (const vl_vector &other_vec) const
+  { return compare (other_vec) >= 0; }
+  /** < 0, 0 or > 0 as this vector comes before, with or after other_vec */
+  int compare (const vl_vector &other_vec) const
+  { return vl_compare (data (), _size, other_vec.data (), other_vec._size); }
 
  protected:
 
-  /** the capacity function. calc it by the formula in ex6 def file */
+  /** the capacity function. the static capacity, or what the policy gives */
   size_t cap_func (size_t k) const
   {
-    return _size + k <= _static_capacity ? _static_capacity : 3 * (_size + k)
-                                                              / 2;
+    return _size + k <= StaticCapacity ? StaticCapacity
+                                       : GrowthPolicy::capacity (_size + k,
+                                                                 sizeof (T));
+  }
+  Allocator &alloc ()
+  { return *this; }
+  const Allocator &alloc () const
+  { return *this; }
+  /** raw heap memory for cap elems, nothing is constructed in it */
+  T *allocate (size_t cap)
+  { return alloc_traits::allocate (alloc (), cap); }
+  /** frees raw heap memory, the elems in it must be destroyed already */
+  void deallocate (T *arr, size_t cap)
+  {
+    if (arr != nullptr)
+      alloc_traits::deallocate (alloc (), arr, cap);
+  }
+  /**
+   * frees the heap array, if there is one. _dynamic_cap is read only then,
+   * in the static array it shares its bytes with the elems
+   */
+  void free_heap ()
+  {
+    if (on_heap ())
+      deallocate (_arr_p, _dynamic_cap);
+  }
+  /**
+   * makes new_array, that the elems were moved into already, the heap array -
+   * frees the old one if there is one
+   */
+  void adopt_heap (T *new_array, size_t new_cap)
+  {
+    stat (on_heap () ? vl_stat_realloc : vl_stat_spill);
+    free_heap ();
+    _arr_p = new_array;
+    _dynamic_cap = new_cap;
+  }
+  /**
+   * records an op in the trace, if VL_ENABLE_TRACE is defined - see
+   * vl_trace.h. source is the other vector of a take / swap
+   */
+  void trace (vl_trace_op op, size_t pos = 0, size_t count = 0,
+              const vl_vector *source = nullptr) const
+  {
+    vl_trace<vl_vector, StaticCapacity, sizeof (T)> (
+        this, _size, op, pos, count, source,
+        source != nullptr ? source->_size : 0);
+  }
+  /** counts count events, if VL_ENABLE_STATS is defined - see vl_stats.h */
+  static void stat (vl_stat_event event, size_t count = 1)
+  { vl_stats_count<vl_vector, StaticCapacity, sizeof (T)> (event, count); }
+  /** grows the heap array to new_cap without moving it, if the allocator can */
+  bool expand_in_place (size_t new_cap)
+  {
+    if constexpr (vl_has_try_expand<Allocator>::value)
+      {
+        if (on_heap () && new_cap > _dynamic_cap
+            && alloc ().try_expand (_arr_p, _dynamic_cap, new_cap))
+          {
+            stat (vl_stat_expand);
+            _dynamic_cap = new_cap;
+            return true;
+          }
+      }
+    return false;
+  }
+  /**
+   * resizes the heap array to new_cap without building a new one - in place,
+   * or realloc style for trivially relocatable elems. returns false if the
+   * allocator can't
+   */
+  bool resize_heap (size_t new_cap)
+  {
+    if (expand_in_place (new_cap))
+      return true;
+    if constexpr (vl_has_reallocate<Allocator>::value
+                  && vl_is_trivially_relocatable<T>::value)
+      {
+        if (on_heap () && new_cap >= _size)
+          {
+            _arr_p = alloc ().reallocate (_arr_p, _dynamic_cap, new_cap);
+            _dynamic_cap = new_cap;
+            stat (vl_stat_expand);
+            return true;
+          }
+      }
+    return false;
+  }
+  /** makes room for count more elems, growing the heap array the usual way */
+  void make_room (size_t count)
+  {
+    if (_size + count > capacity ())
+      realloc_dynamic (cap_func (count));
+  }
+  /** destroys the elems from index new_size on */
+  void truncate (size_t new_size)
+  {
+    destroy (_arr_p + new_size, _arr_p + _size);
+    _size = new_size;
+    shrink_if_needed ();
+  }
+  /** inserts input iterators, that can be walked only once */
+  template<class InputIterator>
+  iterator insert_input (size_t pos, InputIterator first, InputIterator last);
+  /** the index of the first elem equal to value, or _size */
+  size_t find_index (const T &value) const;
+  /** destroys the elems and frees the heap array, leaving the vector empty */
+  void release ();
+  /** takes the elems and heap array of an empty vector, leaving other empty */
+  void take (vl_vector &other);
+  /** destroys the elems in [first, last) */
+  static void destroy (T *first, T *last)
+  {
+    for (; first != last; ++first)
+      first->~T ();
+  }
+  /**
+   * the address of the static array as T. the elems are reached through
+   * _arr_p, this is only where it points when the elems are not on the heap
+   */
+  T *static_arr ()
+  { return reinterpret_cast<T *> (_static_arr); }
+  const T *static_arr () const
+  { return reinterpret_cast<const T *> (_static_arr); }
+  /** tells if the elems are in a heap array */
+  bool on_heap () const
+  { return _arr_p != static_arr (); }
+  /** moves the elems into a new heap array of new_cap elems */
+  void realloc_dynamic (size_t new_cap);
+  /**
+   * moves the elems to new_array, around gap elems at pos that are built
+   * there already, and makes it the heap array. if moving one throws, the
+   * vector is as it was - the gap elems are destroyed and new_array freed
+   */
+  void move_to_heap (T *new_array, size_t new_cap, size_t pos, size_t gap);
+  /** moves the elems back to the static array and frees the heap array */
+  void move_to_static ();
+  /**
+   * gives back heap memory after elems were removed, if the policy says so.
+   * it never throws - if moving the elems or the new array fails, the
+   * vector keeps the array it has
+   */
+  void shrink_if_needed ()
+  {
+    if (on_heap ()
+        && ShrinkPolicy::should_shrink (_size, _dynamic_cap, StaticCapacity))
+      {
+        try
+          {
+            if (_size <= StaticCapacity)
+              move_to_static ();
+            else
+              realloc_dynamic (cap_func (0));
+          }
+        catch (...)
+          {}
+      }
   }
 
   size_t _size; // size of the vector
-  size_t _dynamic_cap; // dynamic allocated capacity
-  T *_dynamic_arr_p; // the dynamic allocated data
-  size_t _static_capacity; // static capacity
-  T _static_arr[StaticCapacity]; // the static array
+  T *_arr_p; // the elems - the heap array, or the static array of this vector
+  union {
+    size_t _dynamic_cap; // dynamic allocated capacity, only with a heap array
+    // a byte at StaticCapacity 0, an array can't be of zero length
+    alignas (T) unsigned char
+        _static_arr[StaticCapacity == 0 ? 1 : StaticCapacity * sizeof (T)];
+  };
 };
 /**
  * returns what in the vector's index place. throws out of range if fails
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param index where to look
  * @return what in the vector's index place
  */
-template<typename T, size_t StaticCapacity>
-T &vl_vector<T, StaticCapacity>::at (size_t index)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+T &
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::at
+    (size_t index)
 {
-  if (index < 0 || index >= _size)
+  if (index >= _size)
     {
       throw std::out_of_range ("Index Out of Range. ");
     }
 
-  if (_dynamic_arr_p == nullptr)
-    return _static_arr[index];
-
-  return _dynamic_arr_p[index];
+  return data ()[index];
 }
 /**
  * returns what in the vector's index place (const). throws out of range if fails
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param index where to look
  * @return what in the vector's index place (const)
  */
-template<typename T, size_t StaticCapacity>
-T vl_vector<T, StaticCapacity>::at (size_t index) const
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+T
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::at
+    (size_t index) const
 {
-  if (index < 0 || index >= _size)
+  if (index >= _size)
     throw std::out_of_range ("Index Out of Range");
 
-  if (_dynamic_arr_p == nullptr)
-    return _static_arr[index];
-
-  return _dynamic_arr_p[index];
+  return data ()[index];
 }
 /**
- *
+ * pushes a copy of elem to the end of the vector
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param elem the elem to push
  */
-template<typename T, size_t StaticCapacity>
-void vl_vector<T, StaticCapacity>::push_back (const T &elem)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::push_back
+    (const T &elem)
 {
-  if (_size < _static_capacity)
-    { // size + 1 <= _static_cap
-      _static_arr[_size] = elem;
+  stat (vl_stat_copy);
+  emplace_back (elem);
+}
+/**
+ * pushes elem to the end of the vector, moving it in
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param elem the elem to push
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::push_back
+    (T &&elem)
+{
+  emplace_back (std::move (elem));
+}
+/**
+ * builds a new elem from args at the end of the vector
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @tparam Args types of the args for T's ctr
+ * @param args the args for T's ctr
+ * @return reference to the new elem
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+template<class... Args>
+T &
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::emplace_back
+    (Args &&... args)
+{
+  trace (vl_trace_push);
+  if (_size < capacity ())
+    {
+      T *slot = ::new (data () + _size) T (std::forward<Args> (args)...);
+      _size++;
+      return *slot;
     }
-  else if (_size == _static_capacity) // size + 1 > _static_cap
+  size_t new_cap = cap_func (1);
+  if (expand_in_place (new_cap))
     {
-      _dynamic_cap = cap_func (1);
-      _dynamic_arr_p = new T[_dynamic_cap];
-
-      for (size_t i = 0; i < _size; ++i)
-        _dynamic_arr_p[i] = _static_arr[i];
-
-      _dynamic_arr_p[_size] = elem;
+      T *slot = ::new (_arr_p + _size) T (std::forward<Args> (args)...);
+      _size++;
+      return *slot;
     }
-  else // size + 1 > _dynamic_cap
+  // the new elem is built before the old ones move, args may refer to them
+  T *new_array = allocate (new_cap);
+  try
     {
-      if (_size + 1 > _dynamic_cap)
-        {
-          _dynamic_cap = cap_func (1);
-          T *new_array = new T[_dynamic_cap];
-          for (size_t i = 0; i < _size; ++i)
-            new_array[i] = _dynamic_arr_p[i];
-          delete[] _dynamic_arr_p;
-          _dynamic_arr_p = new_array;
-        }
-      _dynamic_arr_p[_size] = elem;
+      ::new (new_array + _size) T (std::forward<Args> (args)...);
     }
-  _size++;
+  catch (...)
+    {
+      deallocate (new_array, new_cap);
+      throw;
+    }
+  move_to_heap (new_array, new_cap, _size, 1);
+  return _arr_p[_size++];
 }
 /**
  * insert a single element
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param position iterator to the location to insert in
  * @param new_elem the elem to insert
  * @return iterator to the new element
  */
-template<typename T, size_t StaticCapacity>
-typename vl_vector<T, StaticCapacity>::iterator
-vl_vector<T, StaticCapacity>::insert
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::insert
     (const_iterator position, const T &new_elem)
 {
-  if (_size == 0)
+  stat (vl_stat_copy);
+  return emplace (position, new_elem);
+}
+/**
+ * insert a single element, moving it in
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param position iterator to the location to insert in
+ * @param new_elem the elem to insert
+ * @return iterator to the new element
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::insert
+    (const_iterator position, T &&new_elem)
+{
+  return emplace (position, std::move (new_elem));
+}
+/**
+ * builds a new elem from args in the given position
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @tparam Args types of the args for T's ctr
+ * @param position iterator to the location to insert in
+ * @param args the args for T's ctr
+ * @return iterator to the new element
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+template<class... Args>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::emplace
+    (const_iterator position, Args &&... args)
+{
+  size_t dist = std::distance (cbegin (), position);
+  if (dist == _size)
     {
-      push_back (new_elem);
-      return begin ();
+      emplace_back (std::forward<Args> (args)...);
+      return begin () + dist;
     }
-  size_t dist = std::distance (cbegin (), position);
-  if (_dynamic_cap == 0 && _static_capacity == _size)
+  trace (vl_trace_insert, dist, 1);
+  // args may refer to an elem that is about to move
+  T new_elem (std::forward<Args> (args)...);
+  if (_size == capacity () && !resize_heap (cap_func (1)))
+    {
+      size_t new_cap = cap_func (1);
+      T *new_array = allocate (new_cap);
+      try
+        {
+          ::new (new_array + dist) T (std::move (new_elem));
+        }
+      catch (...)
+        {
+          deallocate (new_array, new_cap);
+          throw;
+        }
+      move_to_heap (new_array, new_cap, dist, 1);
+    }
+  else if constexpr (vl_is_trivially_relocatable<T>::value)
     {
-      _dynamic_cap = cap_func (1);
-      _dynamic_arr_p = new T[_dynamic_cap];
-      for (size_t i = 0; i < _size; ++i)
-        _dynamic_arr_p[i] = _static_arr[i];
+      T *arr = begin ();
+      vl_relocate_overlapping (arr + dist, arr + _size, arr + dist + 1);
+      try
+        {
+          ::new (arr + dist) T (std::move (new_elem));
+        }
+      catch (...)
+        { // close the gap again
+          vl_relocate_overlapping (arr + dist + 1, arr + _size + 1,
+                                   arr + dist);
+          throw;
+        }
     }
-  else if (_dynamic_arr_p != nullptr && _dynamic_cap == _size)
+  else
     {
-      _dynamic_cap = cap_func (1);
-      T *temp_arr = new T[_dynamic_cap];
-      for (size_t i = 0; i < _size; ++i)
-        temp_arr[i] = _dynamic_arr_p[i];
-      delete[] _dynamic_arr_p;
-      _dynamic_arr_p = temp_arr;
+      T *arr = begin ();
+      ::new (arr + _size) T (std::move (arr[_size - 1]));
+      try
+        {
+          std::move_backward (arr + dist, arr + _size - 1, arr + _size);
+          arr[dist] = std::move (new_elem);
+        }
+      catch (...)
+        { // the basic guarantee - the size and the elems stay valid
+          arr[_size].~T ();
+          throw;
+        }
     }
-
-  for (size_t i = _size; i > dist; --i)
-    (*this)[i] = (*this)[i - 1];
-  (*this)[dist] = new_elem;
   _size++;
-  return &at (dist);
+  return begin () + dist;
 }
 
 /**
- * insert a range of elements using iterators
+ * insert a range of elements using iterators. forward iterators are counted
+ * first, so the vector grows at most once - input iterators are appended one
+ * by one and rotated into place
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param position iterator to the location to insert in
- * @tparam ForwardIterator ForwardIterator type of iterator
+ * @tparam InputIterator type of iterator
  * @param first iterator of the first elem to add
  * @param last iterator of the last elem to add
  * @return iterator to the first newly added elem
  */
-template<typename T, size_t StaticCapacity>
-template<class ForwardIterator>
-typename vl_vector<T, StaticCapacity>::iterator
-vl_vector<T, StaticCapacity>::insert
-    (const_iterator position, ForwardIterator first, ForwardIterator last)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+template<class InputIterator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::insert
+    (const_iterator position, InputIterator first, InputIterator last)
 {
-  size_t dist = std::distance (first, last); // k - count of elements to cpy
   size_t pos = std::distance (cbegin (), position); // index of position
-  if (_dynamic_arr_p == nullptr && _size + dist > _static_capacity)
+  if constexpr (!std::is_base_of<std::forward_iterator_tag,
+                                 typename std::iterator_traits<
+                                     InputIterator>::iterator_category>::value)
+    return insert_input (pos, first, last);
+  size_t dist = std::distance (first, last); // k - count of elements to cpy
+  if (dist == 0)
+    return begin () + pos;
+  trace (vl_trace_insert, pos, dist);
+  if constexpr (std::is_lvalue_reference<typename std::iterator_traits<
+      InputIterator>::reference>::value)
+    stat (vl_stat_copy, dist);
+  if (_size + dist > capacity () && !resize_heap (cap_func (dist)))
     {
-      _dynamic_cap = cap_func (dist);
-      _dynamic_arr_p = new T[_dynamic_cap];
-      for (size_t i = 0; i < _size; ++i)
-        _dynamic_arr_p[i] = _static_arr[i];
+      size_t new_cap = cap_func (dist);
+      T *new_array = allocate (new_cap);
+      try
+        {
+          std::uninitialized_copy (first, last, new_array + pos);
+        }
+      catch (...)
+        {
+          deallocate (new_array, new_cap);
+          throw;
+        }
+      move_to_heap (new_array, new_cap, pos, dist);
+      _size += dist;
+      return _arr_p + pos;
     }
-  else if (_dynamic_arr_p != nullptr && _dynamic_cap < dist + _size)
-    {
-      _dynamic_cap = cap_func (dist);
-      T *temp_arr = new T[_dynamic_cap];
-      for (size_t i = 0; i < _size; ++i)
-        temp_arr[i] = _dynamic_arr_p[i];
-      delete[] _dynamic_arr_p;
-      _dynamic_arr_p = temp_arr;
-    }
-  // push all elements after position k places
-  for (size_t i = _size + dist - 1; i > pos + dist - 1; --i)
-    (*this)[i] = (*this)[i - dist];
-  for (size_t i = pos; i < pos + dist; ++i)
+  // push all elements after position k places, the ones that land past
+  // the end are built in the raw memory there
+  T *arr = begin ();
+  size_t elems_after = _size - pos;
+  if constexpr (vl_is_trivially_relocatable<T>::value)
     {
-      (*this)[i] = *first;
-      ++first;
+      vl_relocate_overlapping (arr + pos, arr + _size, arr + pos + dist);
+      try
+        {
+          std::uninitialized_copy (first, last, arr + pos);
+        }
+      catch (...)
+        { // close the gap again
+          vl_relocate_overlapping (arr + pos + dist, arr + _size + dist,
+                                   arr + pos);
+          throw;
+        }
+    }
+  else
+    { // if an elem throws, the ones built past the end are destroyed - the
+      // basic guarantee, the vector keeps its size and valid elems
+      size_t built = 0;
+      try
+        {
+          if (elems_after > dist)
+            {
+              std::uninitialized_move (arr + _size - dist, arr + _size,
+                                       arr + _size);
+              built = dist;
+              std::move_backward (arr + pos, arr + _size - dist, arr + _size);
+              std::copy (first, last, arr + pos);
+            }
+          else
+            {
+              InputIterator mid = first;
+              std::advance (mid, elems_after);
+              std::uninitialized_copy (mid, last, arr + _size);
+              built = dist - elems_after;
+              std::uninitialized_move (arr + pos, arr + _size,
+                                       arr + pos + dist);
+              built = dist;
+              std::copy (first, mid, arr + pos);
+            }
+        }
+      catch (...)
+        {
+          destroy (arr + _size, arr + _size + built);
+          throw;
+        }
     }
   _size += dist;
-  return &at (pos);
+  return arr + pos;
+}
+/**
+ * inserts a range of input iterators - the elems are appended as they are
+ * read, then rotated into place. if one of them throws, the appended elems
+ * are removed again
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @tparam InputIterator type of iterator
+ * @param pos the index to insert in
+ * @param first iterator of the first elem to add
+ * @param last iterator of the last elem to add
+ * @return iterator to the first newly added elem
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+template<class InputIterator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::insert_input
+    (size_t pos, InputIterator first, InputIterator last)
+{
+  size_t old_size = _size;
+  try
+    {
+      for (; first != last; ++first)
+        emplace_back (*first);
+    }
+  catch (...)
+    {
+      truncate (old_size);
+      throw;
+    }
+  std::rotate (_arr_p + pos, _arr_p + old_size, _arr_p + _size);
+  return _arr_p + pos;
+}
+/**
+ * replaces the elems with the elems in [first, last). the heap array is
+ * kept if they fit in it
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @tparam InputIterator type of iterator
+ * @param first iterator of the first elem to assign
+ * @param last iterator of the last elem to assign
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+template<class InputIterator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::assign
+    (InputIterator first, InputIterator last)
+{
+  trace (vl_trace_erase, 0, _size);
+  destroy (_arr_p, _arr_p + _size);
+  _size = 0;
+  insert (cend (), first, last);
+  shrink_if_needed ();
+}
+/**
+ * resizes the vector - removes elems from the end, or appends value
+ * initialized ones
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_size the new size
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::resize
+    (size_t new_size)
+{
+  trace (vl_trace_resize, 0, new_size);
+  if (new_size <= _size)
+    {
+      truncate (new_size);
+      return;
+    }
+  make_room (new_size - _size);
+  std::uninitialized_value_construct (_arr_p + _size, _arr_p + new_size);
+  _size = new_size;
+}
+/**
+ * resizes the vector - removes elems from the end, or appends copies of value
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_size the new size
+ * @param value the elem to copy, it may be in the vector
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::resize
+    (size_t new_size, const T &value)
+{
+  trace (vl_trace_resize, 0, new_size);
+  if (new_size <= _size)
+    {
+      truncate (new_size);
+      return;
+    }
+  stat (vl_stat_copy, new_size - _size);
+  if (new_size > capacity ())
+    { // value may be an elem that is about to move
+      T copy (value);
+      make_room (new_size - _size);
+      std::uninitialized_fill (_arr_p + _size, _arr_p + new_size, copy);
+    }
+  else
+    std::uninitialized_fill (_arr_p + _size, _arr_p + new_size, value);
+  _size = new_size;
+}
+/**
+ * resizes the vector - removes elems from the end, or appends default
+ * initialized ones, which trivial types leave uninitialized
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_size the new size
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::resize_for_overwrite
+    (size_t new_size)
+{
+  if (new_size <= _size)
+    {
+      trace (vl_trace_resize, 0, new_size);
+      truncate (new_size);
+    }
+  else
+    append_uninitialized (new_size - _size);
+}
+/**
+ * appends count default initialized elems - trivial types are left
+ * uninitialized, so a read or a decoder can fill them in place
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param count the number of elems to append
+ * @return iterator to the first appended elem, they run to end ()
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::append_uninitialized
+    (size_t count)
+{
+  trace (vl_trace_insert, _size, count);
+  make_room (count);
+  T *first = _arr_p + _size;
+  std::uninitialized_default_construct (first, first + count);
+  _size += count;
+  return first;
 }
 /**
  * pops the last elem
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  */
-template<typename T, size_t StaticCapacity>
-void vl_vector<T, StaticCapacity>::pop_back ()
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::pop_back
+    ()
 {
   if (_size == 0)
     return;
 
-  if (_dynamic_arr_p != nullptr && _size == _static_capacity + 1)
-    {
-      for (size_t i = 0; i < _size - 1; ++i)
-        _static_arr[i] = _dynamic_arr_p[i];
-      delete[] _dynamic_arr_p;
-      _dynamic_arr_p = nullptr;
-      _dynamic_cap = 0;
-    }
+  trace (vl_trace_pop);
   --_size;
+  data ()[_size].~T ();
+  shrink_if_needed ();
 }
 /**
  * erases an element. gets an iterator to it and removes it
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param elem_to_remove iterator to the elem to remove
  * @return iterator to elem after the one who got removed
  */
-template<typename T, size_t StaticCapacity>
-typename vl_vector<T, StaticCapacity>::iterator
-vl_vector<T, StaticCapacity>::erase (const_iterator elem_to_remove)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::erase
+    (const_iterator elem_to_remove)
 {
   size_t dist = std::distance (cbegin (), elem_to_remove);
-  for (size_t i = dist; i < _size - 1; ++i)
-    at (i) = at (i + 1);
-  _size--;
-  if (_dynamic_arr_p != nullptr && _size == _static_capacity)
+  trace (vl_trace_erase, dist, 1);
+  T *arr = begin ();
+  if constexpr (vl_is_trivially_relocatable<T>::value)
+    {
+      arr[dist].~T ();
+      vl_relocate_overlapping (arr + dist + 1, arr + _size, arr + dist);
+    }
+  else
     {
-      for (size_t i = 0; i < _size; ++i)
-        _static_arr[i] = _dynamic_arr_p[i];
-      delete[] _dynamic_arr_p;
-      _dynamic_arr_p = nullptr;
-      _dynamic_cap = 0;
-      if (dist == _static_capacity)
-        return end ();
+      std::move (arr + dist + 1, arr + _size, arr + dist);
+      arr[_size - 1].~T ();
     }
-  if (size () == 0)
-    return begin ();
-  if (dist == size ())
-    return end ();
-  return &at (dist);
+  _size--;
+  shrink_if_needed ();
+  return begin () + dist;
 }
 /**
  * gets a range (using iterators) of elements, and erase them all
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param first iterator to the first elem to remove
  * @param last iterator to the last elem to remove
  * @return iterator to elem after the last one who got removed
  */
-template<typename T, size_t StaticCapacity>
-typename vl_vector<T, StaticCapacity>::iterator
-vl_vector<T, StaticCapacity>::erase (const_iterator first, const_iterator last)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+typename vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                   Allocator>::iterator
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::erase
+    (const_iterator first, const_iterator last)
 {
   size_t len = std::distance (first, last);
   size_t pos = std::distance (cbegin (), first);
-  for (size_t i = pos; i < _size - len; ++i)
-    at (i) = at (i + len);
-  _size -= len;
-  if (_dynamic_arr_p != nullptr && _size <= _static_capacity)
+  trace (vl_trace_erase, pos, len);
+  T *arr = begin ();
+  if constexpr (vl_is_trivially_relocatable<T>::value)
+    {
+      destroy (arr + pos, arr + pos + len);
+      vl_relocate_overlapping (arr + pos + len, arr + _size, arr + pos);
+    }
+  else
     {
-      for (size_t i = 0; i < _size; ++i)
-        _static_arr[i] = _dynamic_arr_p[i];
-      delete[] _dynamic_arr_p;
-      _dynamic_arr_p = nullptr;
-      _dynamic_cap = 0;
-      if (pos >= _static_capacity)
-        return end ();
-      else if (size () == 0) // clear was made
-        return begin ();
+      std::move (arr + pos + len, arr + _size, arr + pos);
+      destroy (arr + _size - len, arr + _size);
     }
-  if (pos == size ())
-    return end ();
-  return &at (pos);
+  _size -= len;
+  shrink_if_needed ();
+  return begin () + pos;
 }
 /**
  * clears the vector
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  */
-template<typename T, size_t StaticCapacity>
-void vl_vector<T, StaticCapacity>::clear ()
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::clear
+    ()
 {
   if (size () > 0)
     erase (begin (), end ());
 }
 /**
- * functions that grants access to the vector's data
+ * functions that grants access to the vector's data. _arr_p points at the
+ * elems wherever they are, so there is no branch on the storage here
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @return the data of the vector
  */
-template<typename T, size_t StaticCapacity>
-T *vl_vector<T, StaticCapacity>::data ()
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+T *vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::data ()
 {
-  if (_dynamic_arr_p != nullptr)
-    return _dynamic_arr_p;
-  return _static_arr;
+  return _arr_p;
 }
 // same but const data
-template<typename T, size_t StaticCapacity>
-const T *vl_vector<T, StaticCapacity>::data () const
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+const T *
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::data
+    () const
+{
+  return _arr_p;
+}
+/**
+ * makes room for at least new_cap elems, so no reallocation happens until
+ * the size goes over it. with a policy that shrinks on pop_back / erase the
+ * room may be given back once elems are removed
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_cap the wanted capacity
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::reserve
+    (size_t new_cap)
+{
+  trace (vl_trace_reserve, 0, new_cap);
+  if (new_cap > capacity ())
+    realloc_dynamic (new_cap);
+}
+/**
+ * fits the capacity to the size - back to the static array if the elems fit
+ * in it, or a heap array of exactly size elems otherwise. does nothing if the
+ * policy never shrinks
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::shrink_to_fit
+    ()
 {
-  if (_dynamic_arr_p != nullptr)
-    return _dynamic_arr_p;
-  return _static_arr;
+  trace (vl_trace_shrink);
+  if (!ShrinkPolicy::explicit_shrink || !on_heap ())
+    return;
+  if (_size <= StaticCapacity)
+    move_to_static ();
+  else if (_size < _dynamic_cap)
+    realloc_dynamic (_size);
 }
 /**
  *
  * @tparam T the template arg
  * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
  * @param elem_to_check to see if in the vector
  * @return true if found, false otherwise
  */
-template<typename T, size_t StaticCapacity>
-bool vl_vector<T, StaticCapacity>::contains (const T &elem_to_check) const
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+bool
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::contains
+    (const T &elem_to_check) const
 {
-  for (size_t i = 0; i < _size; ++i)
-    {
-      if (at (i) == elem_to_check)
-        return true;
-    }
-  return false;
+  return find_index (elem_to_check) != _size;
+}
+/**
+ * the index of the first elem equal to value - vectorized for arithmetic
+ * types, a plain loop otherwise
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param value the value to look for
+ * @return the index of the elem, or _size if there is none
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+size_t
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::find_index
+    (const T &value) const
+{
+  if constexpr (vl_simd_supported<T>::value)
+    return vl_simd_find (data (), _size, value);
+  else
+    return std::find (begin (), end (), value) - begin ();
+}
+/**
+ * counts the elems equal to value - vectorized for arithmetic types, a plain
+ * loop otherwise
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param value the value to count
+ * @return the number of elems equal to value
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+size_t
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::count
+    (const T &value) const
+{
+  if constexpr (vl_simd_supported<T>::value)
+    return vl_simd_count (data (), _size, value);
+  else
+    return std::count (begin (), end (), value);
 }
 /** copy assignment operator */
-template<typename T, size_t StaticCapacity>
-vl_vector<T, StaticCapacity> &vl_vector<T, StaticCapacity>::operator=
-    (const vl_vector<T, StaticCapacity> &other)
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator> &
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::operator=
+    (const vl_vector &other)
 {
   if (this == &other)
     return *this;
 
-  _size = other._size;
-  _static_capacity = other._static_capacity;
-  _dynamic_cap = other._dynamic_cap;
-
-  if (other._dynamic_arr_p != nullptr)
-    {
-      _dynamic_arr_p = new T[_dynamic_cap];
-      for (size_t i = 0; i < other._size; ++i)
-        _dynamic_arr_p[i] = other._dynamic_arr_p[i];
+  constexpr bool propagate =
+      alloc_traits::propagate_on_container_copy_assignment::value;
+  if constexpr (std::is_nothrow_copy_constructible<T>::value
+                && std::is_nothrow_copy_assignable<T>::value)
+    { // no copy can throw, so the elems are copied into the array we have
+      if (other._size <= capacity ()
+          && (!propagate || alloc () == other.alloc ()))
+        {
+          trace (vl_trace_erase, 0, _size);
+          trace (vl_trace_insert, 0, other._size);
+          stat (vl_stat_copy, other._size);
+          size_t common = std::min (_size, other._size);
+          std::copy (other.begin (), other.begin () + common, begin ());
+          std::uninitialized_copy (other.begin () + common, other.end (),
+                                   begin () + common);
+          destroy (begin () + common, end ());
+          _size = other._size;
+          shrink_if_needed ();
+          return *this;
+        }
     }
-  else
+  // copy and swap - if a copy throws, this vector is untouched
+  vl_vector copy (other, propagate ? other.alloc () : alloc ());
+  release ();
+  if constexpr (propagate)
+    alloc () = other.alloc ();
+  take (copy);
+  return *this;
+}
+/** move assignment operator */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator> &
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::operator=
+    (vl_vector &&other)
+noexcept (std::is_nothrow_move_constructible<T>::value
+          && (alloc_traits::propagate_on_container_move_assignment::value
+              || alloc_traits::is_always_equal::value))
+{
+  if (this == &other)
+    return *this;
+
+  constexpr bool propagate =
+      alloc_traits::propagate_on_container_move_assignment::value;
+  if constexpr (!propagate && !alloc_traits::is_always_equal::value)
     {
-      _dynamic_arr_p = nullptr;
-      for (size_t i = 0; i < other._size; ++i)
-        _static_arr[i] = other._static_arr[i];
+      if (alloc () != other.alloc ())
+        { // our allocator can't free other's heap array, move elem by elem
+          vl_vector moved (alloc ());
+          moved.insert (moved.begin (),
+                        std::make_move_iterator (other.begin ()),
+                        std::make_move_iterator (other.end ()));
+          release ();
+          take (moved);
+          other.clear ();
+          return *this;
+        }
     }
+  release ();
+  if constexpr (propagate)
+    alloc () = std::move (other.alloc ());
+  take (other);
   return *this;
 }
-/** comp operator */
-template<typename T, size_t StaticCapacity>
-bool vl_vector<T, StaticCapacity>::operator==
-    (const vl_vector<T, StaticCapacity> &other_vec) const
+/**
+ * swaps the content of the two vectors. two heap arrays are swapped without
+ * touching the elems, a heap array and static elems trade places with the
+ * static elems relocated, and two static arrays swap their elems. with
+ * propagate_on_container_swap the allocators are swapped on every path
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param other the vector to swap with
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::swap
+    (vl_vector &other)
+noexcept (std::is_nothrow_move_constructible<T>::value
+          && std::is_nothrow_swappable<T>::value
+          && (alloc_traits::propagate_on_container_swap::value
+              || alloc_traits::is_always_equal::value))
 {
-  if (size () != other_vec.size ())
-    return false;
+  if (this == &other)
+    return;
 
-  if (_dynamic_arr_p != nullptr)
+  trace (vl_trace_swap, 0, 0, &other);
+  if (on_heap () && other.on_heap ())
     {
-      for (size_t i = 0; i < _size; ++i)
-        if (_dynamic_arr_p[i] != other_vec._dynamic_arr_p[i])
-          return false;
+      std::swap (_dynamic_cap, other._dynamic_cap);
+      std::swap (_arr_p, other._arr_p);
+    }
+  else if (on_heap () || other.on_heap ())
+    { // the heap array changes hands, the static elems move to the static
+      // array of the other vector - over its _dynamic_cap, kept aside
+      vl_vector &heap_vec = on_heap () ? *this : other;
+      vl_vector &static_vec = on_heap () ? other : *this;
+      T *heap_arr = heap_vec._arr_p;
+      size_t heap_cap = heap_vec._dynamic_cap;
+      if constexpr (std::is_nothrow_move_constructible<T>::value)
+        vl_relocate (static_vec.begin (), static_vec.end (),
+                     heap_vec.static_arr ());
+      else
+        {
+          try
+            {
+              vl_relocate (static_vec.begin (), static_vec.end (),
+                           heap_vec.static_arr ());
+            }
+          catch (...)
+            {
+              heap_vec._dynamic_cap = heap_cap;
+              throw;
+            }
+        }
+      heap_vec._arr_p = heap_vec.static_arr ();
+      static_vec._arr_p = heap_arr;
+      static_vec._dynamic_cap = heap_cap;
     }
   else
+    { // both static - the common elems are swapped, the rest move over
+      vl_vector &longer = _size >= other._size ? *this : other;
+      vl_vector &shorter = _size >= other._size ? other : *this;
+      size_t common = shorter._size;
+      std::swap_ranges (begin (), begin () + common, other.begin ());
+      vl_relocate (longer.begin () + common, longer.end (),
+                   shorter.begin () + common);
+    }
+  std::swap (_size, other._size);
+  // last, so a throwing move above leaves the allocators with their arrays
+  if constexpr (alloc_traits::propagate_on_container_swap::value)
+    std::swap (alloc (), other.alloc ());
+}
+/**
+ * moves the elems into a new heap array of new_cap elems, frees the old heap
+ * array if there is one
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_cap the capacity of the new heap array
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::realloc_dynamic
+    (size_t new_cap)
+{
+  if (resize_heap (new_cap))
+    return;
+  move_to_heap (allocate (new_cap), new_cap, _size, 0);
+}
+/**
+ * moves the elems to new_array with a gap of built elems at pos, and makes
+ * it the heap array. the elems are moved if that can't throw, copied
+ * otherwise, and the old ones are destroyed only once all are in place - so
+ * if one throws, the vector is as it was: the gap elems are destroyed,
+ * new_array is freed, and the exception goes on
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param new_array raw memory for new_cap elems, with the gap elems in it
+ * @param new_cap the capacity of new_array
+ * @param pos the index of the gap
+ * @param gap the number of elems in the gap
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::move_to_heap
+    (T *new_array, size_t new_cap, size_t pos, size_t gap)
+{
+  T *arr = begin ();
+  if constexpr (vl_is_trivially_relocatable<T>::value)
+    {
+      vl_relocate (arr, arr + pos, new_array);
+      vl_relocate (arr + pos, arr + _size, new_array + pos + gap);
+    }
+  else
+    {
+      try
+        {
+          vl_uninitialized_move_if_noexcept (arr, arr + pos, new_array);
+          try
+            {
+              vl_uninitialized_move_if_noexcept (arr + pos, arr + _size,
+                                                 new_array + pos + gap);
+            }
+          catch (...)
+            {
+              destroy (new_array, new_array + pos);
+              throw;
+            }
+        }
+      catch (...)
+        {
+          destroy (new_array + pos, new_array + pos + gap);
+          deallocate (new_array, new_cap);
+          throw;
+        }
+      destroy (arr, arr + _size);
+    }
+  adopt_heap (new_array, new_cap);
+}
+/**
+ * moves the elems back to the static array and frees the heap array
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::move_to_static
+    ()
+{
+  stat (vl_stat_to_static);
+  // the elems overwrite _dynamic_cap, keep it for the deallocation
+  T *heap_arr = _arr_p;
+  size_t heap_cap = _dynamic_cap;
+  if constexpr (vl_is_trivially_relocatable<T>::value)
+    vl_relocate (heap_arr, heap_arr + _size, static_arr ());
+  else
+    {
+      try
+        {
+          vl_uninitialized_move_if_noexcept (heap_arr, heap_arr + _size,
+                                             static_arr ());
+        }
+      catch (...)
+        { // the elems built were destroyed, the heap array stays
+          _dynamic_cap = heap_cap;
+          throw;
+        }
+      destroy (heap_arr, heap_arr + _size);
+    }
+  deallocate (heap_arr, heap_cap);
+  _arr_p = static_arr ();
+}
+/**
+ * destroys the elems and frees the heap array, leaving the vector empty
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::release
+    ()
+{
+  trace (vl_trace_release);
+  destroy (begin (), end ());
+  free_heap ();
+  _size = 0;
+  _arr_p = static_arr ();
+}
+/**
+ * takes the elems of other into this empty vector - its heap array if it
+ * has one, or its static elems one by one. the allocators must be able to
+ * free each other's memory
+ * @tparam T the template arg
+ * @tparam StaticCapacity the static capacity of the vector
+ * @tparam ShrinkPolicy when the vector gives back heap memory
+ * @tparam GrowthPolicy how much the heap array grows
+ * @tparam Allocator where the heap array comes from
+ * @param other the vector to take the elems of
+ */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::take
+    (vl_vector &other)
+{
+  trace (vl_trace_take, 0, 0, &other);
+  if (other.on_heap ())
     {
-      for (size_t i = 0; i < _size; ++i)
-        if (_static_arr[i] != other_vec._static_arr[i])
-          return false;
+      _arr_p = other._arr_p;
+      _dynamic_cap = other._dynamic_cap;
     }
-  return true;
+  else
+    vl_relocate (other.begin (), other.end (), _arr_p);
+  _size = other._size;
+  other._size = 0;
+  other._arr_p = other.static_arr ();
+}
+/** swaps the content of the two vectors */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+void swap
+    (vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator> &lhs,
+     vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator> &rhs)
+noexcept (noexcept (lhs.swap (rhs)))
+{ lhs.swap (rhs); }
+/** comp operator */
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+bool
+vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy, Allocator>::operator==
+    (const vl_vector &other_vec) const
+{
+  if (_size != other_vec._size)
+    return false;
+
+  return vl_equal (data (), other_vec.data (), _size);
+}
+
+/** hashes the elems in bulk if their bytes are their value - see vl_hash.h */
+namespace std {
+template<typename T, size_t StaticCapacity, class ShrinkPolicy,
+    class GrowthPolicy, class Allocator>
+struct hash<vl_vector<T, StaticCapacity, ShrinkPolicy, GrowthPolicy,
+                      Allocator>> {
+  size_t operator() (const vl_vector<T, StaticCapacity, ShrinkPolicy,
+                                    GrowthPolicy, Allocator> &vec) const
+  { return vl_hash_range (vec.data (), vec.size ()); }
+};
 }
 
 #endif //_VL_VECTOR_H_